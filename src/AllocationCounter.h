@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+// Debug heap-allocation counter for checking that the hot paths stay allocation-free.
+// Configuring with -DSUDOKU_COUNT_ALLOCATIONS=ON replaces the global operator new (in
+// AllocationCounter.cpp) so that every allocation bumps a per-thread count; otherwise
+// nothing is replaced and the count stays 0.
+#ifdef SUDOKU_COUNT_ALLOCATIONS
+#define SUDOKU_ALLOCATIONS_COUNTED 1
+#else
+#define SUDOKU_ALLOCATIONS_COUNTED 0
+#endif
+
+// operator new calls made by the calling thread so far.
+uint64_t threadAllocations();
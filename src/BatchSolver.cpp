@@ -0,0 +1,283 @@
+#include "BatchSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include "CandidateSolver.h"
+#include "DlxSolver.h"
+#include "PuzzleIO.h"
+
+namespace {
+
+// Replaces the trailing newline of the last result with tab-separated search counters.
+void appendWork(std::string& out, const SearchStats& stats)
+{
+    out.pop_back();
+    out += "\tnodes=" + std::to_string(stats.nodes) + " backtracks=" + std::to_string(stats.backtracks) +
+        " depth=" + std::to_string(stats.maxDepth) + '\n';
+}
+
+template <int BR, int BC>
+void processVariantLine(std::string_view line, const BatchOptions& opt, std::string& out)
+{
+    using Board = BasicBoard<BR, BC>;
+    Board board, solved;
+    if (!parsePuzzleLine(line, board)) { out += "invalid\n"; return; }
+    int limit = opt.count ? opt.limit : 1, n;
+    SearchStats stats;
+    SearchStats* work = opt.work ? &stats : nullptr;
+    if (opt.engine == Engine::DancingLinks) {
+        thread_local BasicDlxSolver<BR, BC> dlx;
+        dlx.setStats(work);
+        n = dlx.solve(board, limit, &solved);
+        dlx.setStats(nullptr);
+    }
+    else {
+        thread_local BasicCandidateSolver<BR, BC> candidates;
+        candidates.setStats(work);
+        n = candidates.solve(board, limit, &solved);
+        candidates.setStats(nullptr);
+    }
+    if (opt.count) {
+        out += std::to_string(n);
+        out += '\n';
+    }
+    else if (n > 0) {
+        size_t at = out.size();
+        out.resize(at + Board::kCells + 1);
+        formatPuzzleLine(solved, &out[at]);
+        out.back() = '\n';
+    }
+    else {
+        out += "none\n";
+    }
+    if (work) appendWork(out, stats);
+}
+
+}
+
+BatchSolver::BatchSolver(unsigned threads) : pool_(threads)
+{
+    for (unsigned i = 0; i < pool_.size(); ++i) workers_.push_back(std::make_unique<Worker>());
+}
+
+std::vector<WorkerCounters> BatchSolver::counters() const
+{
+    std::vector<WorkerCounters> out;
+    for (const auto& w : workers_)
+        out.push_back({ w->puzzles.load(), w->busyNanos.load() * 1e-9 });
+    return out;
+}
+
+std::array<StageCounters, RatingPipeline::kStages> BatchSolver::stageCounters() const
+{
+    std::array<StageCounters, RatingPipeline::kStages> sum{};
+    for (const auto& w : workers_)
+        for (int i = 0; i < RatingPipeline::kStages; ++i) {
+            const StageCounters& c = w->rating.counters()[i];
+            sum[i].boards += c.boards;
+            sum[i].settled += c.settled;
+            sum[i].seconds += c.seconds;
+        }
+    return sum;
+}
+
+void BatchSolver::resetCounters()
+{
+    for (auto& w : workers_) { w->puzzles = 0; w->busyNanos = 0; w->rating.resetCounters(); }
+}
+
+bool BatchSolver::supportsGeometry(int boxRows, int boxCols)
+{
+    return (boxRows == 2 && (boxCols == 2 || boxCols == 3)) || (boxRows == boxCols && boxRows >= 3 && boxRows <= 5);
+}
+
+bool BatchSolver::processLine(Service& service, std::string_view line, const BatchOptions& opt, std::string& out)
+{
+    if (line.empty() || line[0] == '#' || line[0] == '\r') return false;
+    if (opt.boxRows != 3 || opt.boxCols != 3) {
+        switch (opt.boxRows * 10 + opt.boxCols) {
+        case 22: processVariantLine<2, 2>(line, opt, out); break;
+        case 23: processVariantLine<2, 3>(line, opt, out); break;
+        case 44: processVariantLine<4, 4>(line, opt, out); break;
+        case 55: processVariantLine<5, 5>(line, opt, out); break;
+        default: out += "invalid\n"; break;
+        }
+        return true;
+    }
+    SudokuBoard board;
+    if (!parsePuzzleLine(line, board)) { out += "invalid\n"; return true; }
+    processBoard(service, board, opt, out);
+    return true;
+}
+
+void BatchSolver::processBoard(Service& service, const SudokuBoard& board, const BatchOptions& opt, std::string& out)
+{
+    service.loadBoard(board);
+    service.setCache(opt.cache);
+    SearchStats stats;
+    if (opt.work) service.setStats(&stats);
+    if (opt.rate) {
+        char buf[16];
+        std::snprintf(buf, sizeof buf, "%.1f\n", service.rateDifficulty());
+        out += buf;
+    }
+    else if (opt.count) {
+        out += std::to_string(service.countSolutions(opt.limit));
+        out += '\n';
+    }
+    else if (service.solve()) {
+        size_t at = out.size();
+        out.resize(at + 82);
+        formatPuzzleLine(service.getBoard(), &out[at]);
+        out[at + 81] = '\n';
+    }
+    else {
+        out += "none\n";
+    }
+    if (opt.work) { service.setStats(nullptr); appendWork(out, stats); }
+}
+
+uint64_t BatchSolver::rateChunk(Worker& w, std::string_view text, const MappedCorpus* corpus, uint64_t first,
+    uint64_t records, std::string& out)
+{
+    w.boards.clear();
+    w.results.clear();
+    SudokuBoard board;
+    if (corpus) {
+        for (uint64_t i = first; i < first + records; ++i) {
+            corpus->puzzle(i).unpack(board);
+            w.results.push_back(int32_t(w.boards.size()));
+            w.boards.push_back(board);
+        }
+    }
+    else {
+        for (size_t pos = 0; pos < text.size();) {
+            size_t end = text.find('\n', pos);
+            std::string_view line = text.substr(pos, end - pos);
+            pos = end + 1;
+            if (line.empty() || line[0] == '#' || line[0] == '\r') continue;
+            if (!parsePuzzleLine(line, board)) { w.results.push_back(-1); continue; }
+            w.results.push_back(int32_t(w.boards.size()));
+            w.boards.push_back(board);
+        }
+    }
+    w.ratings.resize(w.boards.size());
+    w.rating.setCountLeftovers(false);  // only the rating is printed
+    w.rating.rate(w.boards.data(), w.boards.size(), w.ratings.data());
+    char buf[16];
+    for (int32_t i : w.results) {
+        if (i < 0) { out += "invalid\n"; continue; }
+        std::snprintf(buf, sizeof buf, "%.1f\n", w.ratings[size_t(i)].rating);
+        out += buf;
+    }
+    return w.results.size();
+}
+
+uint64_t BatchSolver::run(std::istream& in, std::ostream& out, const BatchOptions& opt)
+{
+    return runChunks(&in, nullptr, out, opt);
+}
+
+uint64_t BatchSolver::run(const MappedCorpus& corpus, std::ostream& out, const BatchOptions& opt)
+{
+    return runChunks(nullptr, &corpus, out, opt);
+}
+
+uint64_t BatchSolver::runChunks(std::istream* in, const MappedCorpus* corpus, std::ostream& out, const BatchOptions& opt)
+{
+    struct Slot {
+        std::string input, output;
+        uint64_t first = 0, records = 0;  // corpus range
+        uint64_t puzzles = 0;
+        bool ready = false;
+    };
+
+    const size_t capacity = opt.maxInFlight ? opt.maxInFlight : size_t(threads()) * 4;
+    std::vector<Slot> ring(capacity);
+    std::mutex m;
+    std::condition_variable readyCv;
+    uint64_t submitted = 0, written = 0, total = 0;
+
+    for (auto& w : workers_) w->service.setEngine(opt.engine);
+    // Cached ratings are looked up per board and --work wants per-board counters.
+    const bool staged = opt.rate && !opt.cache && !opt.work && opt.boxRows == 3 && opt.boxCols == 3;
+
+    auto flushOne = [&] {
+        Slot& slot = ring[written % capacity];
+        {
+            std::unique_lock<std::mutex> lk(m);
+            readyCv.wait(lk, [&] { return slot.ready; });
+        }
+        out.write(slot.output.data(), std::streamsize(slot.output.size()));
+        total += slot.puzzles;
+        slot.ready = false;
+        ++written;
+    };
+
+    std::string line;
+    bool eof = false;
+    uint64_t nextRecord = 0;
+    while (!eof) {
+        if (submitted - written == capacity) flushOne();
+        Slot& slot = ring[submitted % capacity];
+        size_t lines = 0;
+        if (corpus) {
+            slot.first = nextRecord;
+            slot.records = std::min<uint64_t>(opt.chunkSize, corpus->size() - nextRecord);
+            nextRecord += slot.records;
+            lines = size_t(slot.records);
+            eof = nextRecord == corpus->size();
+        }
+        else {
+            slot.input.clear();
+            while (lines < opt.chunkSize) {
+                if (!std::getline(*in, line)) { eof = true; break; }
+                slot.input += line;
+                slot.input += '\n';
+                ++lines;
+            }
+        }
+        if (lines == 0) break;
+
+        pool_.submit([this, &slot, corpus, &opt, staged, &m, &readyCv](unsigned wi) {
+            Worker& w = *workers_[wi];
+            auto t0 = std::chrono::steady_clock::now();
+            slot.output.clear();
+            uint64_t n = 0;
+            if (staged) {
+                n = rateChunk(w, slot.input, corpus, slot.first, slot.records, slot.output);
+            }
+            else if (corpus) {
+                SudokuBoard board;
+                for (uint64_t i = slot.first; i < slot.first + slot.records; ++i, ++n) {
+                    corpus->puzzle(i).unpack(board);
+                    processBoard(w.service, board, opt, slot.output);
+                }
+            }
+            else {
+                std::string_view text = slot.input;
+                for (size_t pos = 0; pos < text.size();) {
+                    size_t end = text.find('\n', pos);
+                    if (processLine(w.service, text.substr(pos, end - pos), opt, slot.output)) ++n;
+                    pos = end + 1;
+                }
+            }
+            slot.puzzles = n;
+            w.puzzles += n;
+            w.busyNanos += uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - t0).count());
+            std::lock_guard<std::mutex> lk(m);
+            slot.ready = true;
+            readyCv.notify_all();
+        });
+        ++submitted;
+    }
+    while (written < submitted) flushOne();
+    pool_.wait();
+    out.flush();
+    return total;
+}
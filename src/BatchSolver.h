@@ -0,0 +1,83 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "BinaryCorpus.h"
+#include "RatingPipeline.h"
+#include "Service.h"
+#include "WorkStealingPool.h"
+
+struct BatchOptions {
+    Engine engine = Engine::Candidates;
+    bool count = false;
+    bool rate = false;        // print Service::rateDifficulty() instead (9x9 only); staged
+                              // through RatingPipeline per chunk unless `cache` or `work` is set
+    int limit = 2;
+    int boxRows = 3;          // puzzle geometry; see BatchSolver::supportsGeometry
+    int boxCols = 3;
+    size_t chunkSize = 2048;  // input lines per task
+    size_t maxInFlight = 0;   // chunks read ahead of the writer; 0 = four per worker
+    bool work = false;        // append per-puzzle search counters to each result line
+    PuzzleCache* cache = nullptr;  // shared by all workers for 9x9 puzzles; see Service::setCache
+};
+
+struct WorkerCounters {
+    uint64_t puzzles;
+    double busySeconds;
+    double puzzlesPerSecond() const { return busySeconds > 0 ? puzzles / busySeconds : 0.0; }
+};
+
+// Streams puzzle lines through a work-stealing pool. The reader thread cuts the input
+// into chunks, workers solve them with their own Service, and a bounded reorder ring
+// hands finished chunks back to the writer in input order.
+class BatchSolver {
+public:
+    explicit BatchSolver(unsigned threads = 0);
+
+    unsigned threads() const { return pool_.size(); }
+
+    // Writes one result line per puzzle line of `in` to `out` and returns the number of
+    // puzzles processed. Blank lines and lines starting with '#' produce no output.
+    uint64_t run(std::istream& in, std::ostream& out, const BatchOptions& opt);
+    // Same for every record of a 9x9 binary corpus; chunks are cut by record index.
+    uint64_t run(const MappedCorpus& corpus, std::ostream& out, const BatchOptions& opt);
+
+    std::vector<WorkerCounters> counters() const;
+    // Per-stage counters of the staged --rate path, summed over the workers.
+    std::array<StageCounters, RatingPipeline::kStages> stageCounters() const;
+    void resetCounters();
+
+    // 2x2, 2x3, 3x3, 4x4 and 5x5 boxes. Non-9x9 puzzles bypass Service and run the
+    // templated engines directly (backtracking falls back to the candidate engine).
+    static bool supportsGeometry(int boxRows, int boxCols);
+
+    // Appends the result line for one input line to `out`; false for skipped lines.
+    static bool processLine(Service& service, std::string_view line, const BatchOptions& opt, std::string& out);
+    // Appends the result line for one 9x9 puzzle.
+    static void processBoard(Service& service, const SudokuBoard& board, const BatchOptions& opt, std::string& out);
+
+private:
+    struct alignas(64) Worker {
+        Service service;
+        RatingPipeline rating;
+        std::vector<SudokuBoard> boards;
+        std::vector<int32_t> results;  // per result line: index into `boards`, or -1 for "invalid"
+        std::vector<PuzzleRating> ratings;
+        std::atomic<uint64_t> puzzles{ 0 };
+        std::atomic<uint64_t> busyNanos{ 0 };
+    };
+
+    WorkStealingPool pool_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    // Reads chunks from `in` or, when it is null, from `corpus`.
+    uint64_t runChunks(std::istream* in, const MappedCorpus* corpus, std::ostream& out, const BatchOptions& opt);
+    // Rates a whole chunk as one RatingPipeline batch; returns the puzzles processed.
+    static uint64_t rateChunk(Worker& w, std::string_view text, const MappedCorpus* corpus, uint64_t first,
+        uint64_t records, std::string& out);
+};
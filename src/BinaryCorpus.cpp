@@ -0,0 +1,256 @@
+#include "BinaryCorpus.h"
+#include <cstdio>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include "PuzzleIO.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char kMagic[4] = { 'S', 'D', 'K', 'B' };
+constexpr uint16_t kVersion = 1;
+
+void putLe(uint8_t* p, uint64_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) p[i] = uint8_t(v >> (8 * i));
+}
+
+uint64_t getLe(const uint8_t* p, int bytes)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i) v |= uint64_t(p[i]) << (8 * i);
+    return v;
+}
+
+void writeHeader(uint8_t* h, bool withSolutions, uint64_t count)
+{
+    std::memset(h, 0, kCorpusHeaderBytes);
+    std::memcpy(h, kMagic, 4);
+    putLe(h + 4, kVersion, 2);
+    h[6] = 3;
+    h[7] = 3;
+    putLe(h + 8, withSolutions ? kCorpusHasSolutions : 0, 4);
+    putLe(h + 12, withSolutions ? 2 * kPackedGridBytes : kPackedGridBytes, 4);
+    putLe(h + 16, count, 8);
+    putLe(h + 24, kCorpusHeaderBytes, 8);
+}
+
+}
+
+void packGrid(const SudokuBoard& board, uint8_t* out)
+{
+    std::memset(out, 0, kPackedGridBytes);
+    for (int i = 0; i < 81; ++i) out[i >> 1] |= uint8_t(board.at(i / 9, i % 9) << ((i & 1) * 4));
+}
+
+void PackedGrid::unpack(SudokuBoard& out) const
+{
+    SudokuBoard b;
+    for (int i = 0; i < 81; ++i) {
+        const int v = (bytes_[i >> 1] >> ((i & 1) * 4)) & 15;
+        if (v >= 1 && v <= 9) b.put(i / 9, i % 9, v);
+    }
+    out = b;
+}
+
+CorpusWriter::CorpusWriter(const std::string& path, bool withSolutions)
+    : path_(path), out_(path, std::ios::binary | std::ios::trunc), withSolutions_(withSolutions)
+{
+    uint8_t header[kCorpusHeaderBytes];
+    writeHeader(header, withSolutions_, 0);
+    out_.write(reinterpret_cast<const char*>(header), kCorpusHeaderBytes);
+}
+
+CorpusWriter::~CorpusWriter()
+{
+    finish();
+}
+
+bool CorpusWriter::add(const SudokuBoard& puzzle, const SudokuBoard* solution)
+{
+    if (finished_ || (withSolutions_ && !solution)) return false;
+    uint8_t record[2 * kPackedGridBytes];
+    packGrid(puzzle, record);
+    if (withSolutions_) packGrid(*solution, record + kPackedGridBytes);
+    out_.write(reinterpret_cast<const char*>(record), std::streamsize(withSolutions_ ? 2 * kPackedGridBytes : kPackedGridBytes));
+    if (!out_) return false;
+    ++count_;
+    return true;
+}
+
+bool CorpusWriter::finish()
+{
+    if (finished_) return bool(out_);
+    finished_ = true;
+    uint8_t header[kCorpusHeaderBytes];
+    writeHeader(header, withSolutions_, count_);
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(header), kCorpusHeaderBytes);
+    out_.close();
+    return !out_.fail();
+}
+
+void CorpusWriter::abandon()
+{
+    if (finished_) return;
+    finished_ = true;
+    out_.close();
+    std::remove(path_.c_str());
+}
+
+MappedCorpus::~MappedCorpus()
+{
+    close();
+}
+
+bool MappedCorpus::isCorpusFile(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    char magic[4];
+    return in.read(magic, 4) && std::memcmp(magic, kMagic, 4) == 0;
+}
+
+bool MappedCorpus::open(const std::string& path)
+{
+    close();
+    error_.clear();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { error_ = "cannot open " + path; return false; }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || uint64_t(size.QuadPart) > SIZE_MAX) {
+        CloseHandle(file);
+        error_ = "cannot size " + path;
+        return false;
+    }
+    HANDLE mapping = size.QuadPart ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        error_ = "cannot map " + path;
+        return false;
+    }
+    file_ = file;
+    mapping_ = mapping;
+    bytes_ = size_t(size.QuadPart);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { error_ = "cannot open " + path; return false; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || uint64_t(st.st_size) > SIZE_MAX) {
+        ::close(fd);
+        error_ = "cannot size " + path;
+        return false;
+    }
+    void* view = st.st_size ? mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (view == MAP_FAILED) { error_ = "cannot map " + path; return false; }
+    bytes_ = size_t(st.st_size);
+#endif
+    data_ = static_cast<const uint8_t*>(view);
+
+    const uint8_t* h = data_;
+    if (bytes_ < kCorpusHeaderBytes || std::memcmp(h, kMagic, 4) != 0) error_ = path + " is not a puzzle corpus";
+    else if (getLe(h + 4, 2) != kVersion) error_ = path + ": unsupported corpus version";
+    else if (h[6] != 3 || h[7] != 3) error_ = path + ": only 9x9 corpora are supported";
+    else {
+        flags_ = uint32_t(getLe(h + 8, 4));
+        recordSize_ = size_t(getLe(h + 12, 4));
+        count_ = getLe(h + 16, 8);
+        const uint64_t offset = getLe(h + 24, 8);
+        const size_t minRecord = hasSolutions() ? 2 * kPackedGridBytes : kPackedGridBytes;
+        if (recordSize_ < minRecord || offset < kCorpusHeaderBytes || offset > bytes_ ||
+            count_ > (bytes_ - offset) / recordSize_)
+            error_ = path + ": truncated or corrupt corpus";
+        else records_ = data_ + offset;
+    }
+    if (!error_.empty()) { close(); return false; }
+#ifndef _WIN32
+    // Batch jobs walk the corpus front to back.
+    madvise(const_cast<uint8_t*>(data_), bytes_, MADV_SEQUENTIAL);
+#endif
+    return true;
+}
+
+void MappedCorpus::close()
+{
+    if (data_) {
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+        CloseHandle(mapping_);
+        CloseHandle(file_);
+        mapping_ = file_ = nullptr;
+#else
+        munmap(const_cast<uint8_t*>(data_), bytes_);
+#endif
+    }
+    data_ = records_ = nullptr;
+    bytes_ = recordSize_ = 0;
+    count_ = 0;
+    flags_ = 0;
+}
+
+int64_t packText(std::istream& in, const std::string& path, std::string& error)
+{
+    std::unique_ptr<CorpusWriter> writer;
+    std::string line;
+    uint64_t lineNo = 0;
+    SudokuBoard puzzle, solution;
+    auto fail = [&](std::string message) {
+        error = std::move(message);
+        writer->abandon();
+        return -1;
+    };
+    while (std::getline(in, line)) {
+        ++lineNo;
+        if (line.empty() || line[0] == '#' || line[0] == '\r') continue;
+        const bool hasSolution = line.size() >= 2 * 81 + 1 && parsePuzzleLine(std::string_view(line).substr(82), solution);
+        if (!writer) {
+            writer = std::make_unique<CorpusWriter>(path, hasSolution);
+            if (!writer->ok()) return fail("cannot create " + path);
+        }
+        if (!parsePuzzleLine(line, puzzle) || hasSolution != writer->hasSolutions())
+            return fail("line " + std::to_string(lineNo) + (hasSolution != writer->hasSolutions()
+                ? ": solutions must be given for all puzzles or none" : ": invalid puzzle"));
+        if (!writer->add(puzzle, &solution)) return fail("cannot write " + path);
+    }
+    if (!writer) writer = std::make_unique<CorpusWriter>(path, false);
+    const uint64_t count = writer->count();
+    if (!writer->finish()) {
+        std::remove(path.c_str());
+        error = "cannot write " + path;
+        return -1;
+    }
+    return int64_t(count);
+}
+
+void unpackText(const MappedCorpus& corpus, std::ostream& out)
+{
+    const size_t width = corpus.hasSolutions() ? 2 * 81 + 2 : 82;
+    std::string text(width, ',');
+    text.back() = '\n';
+    SudokuBoard b;
+    for (uint64_t i = 0; i < corpus.size(); ++i) {
+        corpus.puzzle(i).unpack(b);
+        formatPuzzleLine(b, &text[0]);
+        if (corpus.hasSolutions()) {
+            corpus.solution(i).unpack(b);
+            formatPuzzleLine(b, &text[82]);
+        }
+        out.write(text.data(), std::streamsize(width));
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iosfwd>
+#include <string>
+#include "SudokuBoard.h"
+
+// Binary 9x9 corpus (.sdkb). A 32-byte little-endian header
+//
+//   0  char[4] "SDKB"      12  u32 record size in bytes
+//   4  u16 version (1)     16  u64 record count
+//   6  u8 box rows, cols   24  u64 offset of record 0
+//   8  u32 flags (bit 0: records carry a solution)
+//
+// is followed by fixed-size records, so record i starts at offset + i * size and the
+// header doubles as the index. A record is the puzzle packed 4 bits per cell (cell i in
+// the low nibble of byte i/2 when i is even, the high nibble otherwise, 0 = empty),
+// followed by the solution in the same form when the flag is set.
+constexpr size_t kPackedGridBytes = 41;
+constexpr size_t kCorpusHeaderBytes = 32;
+constexpr uint32_t kCorpusHasSolutions = 1;
+
+void packGrid(const SudokuBoard& board, uint8_t* out);
+
+// Read-only view of one packed grid, typically inside a MappedCorpus.
+class PackedGrid {
+public:
+    explicit PackedGrid(const uint8_t* bytes) : bytes_(bytes) {}
+
+    int at(int r, int c) const { const int i = r * 9 + c; return (bytes_[i >> 1] >> ((i & 1) * 4)) & 15; }
+    const uint8_t* data() const { return bytes_; }
+    // Decodes into `out` directly; no text round trip.
+    void unpack(SudokuBoard& out) const;
+    SudokuBoard board() const { SudokuBoard b; unpack(b); return b; }
+
+private:
+    const uint8_t* bytes_;
+};
+
+// Appends records to a new corpus file. The record count is patched into the header by
+// finish(), which the destructor calls if needed; abandon() deletes the file instead,
+// so a failed conversion does not leave a short corpus that loads cleanly.
+class CorpusWriter {
+public:
+    CorpusWriter(const std::string& path, bool withSolutions);
+    ~CorpusWriter();
+
+    CorpusWriter(const CorpusWriter&) = delete;
+    CorpusWriter& operator=(const CorpusWriter&) = delete;
+
+    bool ok() const { return bool(out_); }
+    bool hasSolutions() const { return withSolutions_; }
+    uint64_t count() const { return count_; }
+
+    // `solution` is required when the corpus carries solutions and ignored otherwise.
+    bool add(const SudokuBoard& puzzle, const SudokuBoard* solution = nullptr);
+    bool finish();
+    void abandon();
+
+private:
+    std::string path_;
+    std::ofstream out_;
+    bool withSolutions_;
+    bool finished_ = false;
+    uint64_t count_ = 0;
+};
+
+// Memory-mapped corpus: opening validates the header and maps the file, after which any
+// record is a pointer offset away. The mapping is read-only and safe to share between
+// threads.
+class MappedCorpus {
+public:
+    MappedCorpus() = default;
+    ~MappedCorpus();
+
+    MappedCorpus(const MappedCorpus&) = delete;
+    MappedCorpus& operator=(const MappedCorpus&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    // Why the last open() failed.
+    const std::string& error() const { return error_; }
+
+    bool isOpen() const { return data_ != nullptr; }
+    uint64_t size() const { return count_; }
+    bool hasSolutions() const { return (flags_ & kCorpusHasSolutions) != 0; }
+
+    PackedGrid puzzle(uint64_t i) const { return PackedGrid(records_ + i * recordSize_); }
+    PackedGrid solution(uint64_t i) const { return PackedGrid(records_ + i * recordSize_ + kPackedGridBytes); }
+
+    // True when the file starts with the corpus magic, to tell it apart from text input.
+    static bool isCorpusFile(const std::string& path);
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t bytes_ = 0;
+    const uint8_t* records_ = nullptr;
+    uint64_t count_ = 0;
+    size_t recordSize_ = 0;
+    uint32_t flags_ = 0;
+    std::string error_;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+// Text conversion. Input lines hold a puzzle in the 81-character form, optionally
+// followed by one separator character and its solution ("puzzle,solution"); the first
+// puzzle line decides whether the corpus carries solutions. Blank lines and '#' comments
+// are skipped. packText writes `path` and returns the number of records, or -1 with the
+// first bad line described in `error`. unpackText writes the same form back.
+int64_t packText(std::istream& in, const std::string& path, std::string& error);
+void unpackText(const MappedCorpus& corpus, std::ostream& out);
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+inline int popCount(uint32_t m)
+{
+#if defined(_MSC_VER)
+    return int(__popcnt(m));
+#else
+    return __builtin_popcount(m);
+#endif
+}
+
+// Index of the lowest set bit; m must be non-zero.
+inline int lowestBit(uint32_t m)
+{
+#if defined(_MSC_VER)
+    unsigned long i; _BitScanForward(&i, m); return int(i);
+#else
+    return __builtin_ctz(m);
+#endif
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Cooperative stop request for a long search. Any thread may cancel() it; the owner can
+// also give it a timeout before the search starts. The search calls poll() once per
+// node, which every kPollInterval nodes checks the deadline and publishes the node count
+// so other threads can show progress. One search at a time per token; parallel searches
+// each take a token linked to a shared parent.
+class CancelToken {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr uint64_t kPollInterval = 1024;
+
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+    void setTimeout(Clock::duration timeout) { deadline_ = Clock::now() + timeout; hasDeadline_ = true; }
+
+    // Also stops when `parent` is cancelled and takes over its deadline; running out of
+    // time then times out the parent (and its own parents) too.
+    void linkTo(CancelToken& parent)
+    {
+        parent_ = &parent;
+        deadline_ = parent.deadline_;
+        hasDeadline_ = parent.hasDeadline_;
+    }
+
+    bool cancelled() const
+    {
+        return cancelled_.load(std::memory_order_relaxed) || (parent_ && parent_->cancelled());
+    }
+    bool timedOut() const { return timedOut_.load(std::memory_order_relaxed); }
+    uint64_t nodes() const { return nodes_.load(std::memory_order_relaxed); }
+
+    // True once the search should unwind.
+    bool poll()
+    {
+        if ((++local_ & (kPollInterval - 1)) == 0) {
+            nodes_.store(local_, std::memory_order_relaxed);
+            if (hasDeadline_ && Clock::now() >= deadline_) expire();
+        }
+        return cancelled();
+    }
+
+private:
+    std::atomic<bool> cancelled_{ false };
+    std::atomic<bool> timedOut_{ false };
+    std::atomic<uint64_t> nodes_{ 0 };
+    uint64_t local_ = 0;
+    Clock::time_point deadline_{};
+    bool hasDeadline_ = false;
+    CancelToken* parent_ = nullptr;
+
+    void expire()
+    {
+        timedOut_.store(true, std::memory_order_relaxed);
+        cancel();
+        if (parent_) parent_->expire();
+    }
+};
@@ -0,0 +1,154 @@
+#include "CandidateGrid.h"
+#include "Bits.h"
+#include "SimdKernels.h"
+
+namespace {
+
+struct GridTables {
+    std::array<std::array<uint8_t, 9>, CandidateGrid::kUnits> units;
+    std::array<std::array<uint8_t, 3>, 81> unitsOf;
+    std::array<std::array<uint8_t, 3>, 81> posIn;  // index of the cell within each of its units
+    std::array<std::array<uint8_t, 20>, 81> peers;
+
+    GridTables() {
+        for (int i = 0; i < 9; ++i)
+            for (int j = 0; j < 9; ++j) {
+                units[i][j] = uint8_t(i * 9 + j);
+                units[9 + i][j] = uint8_t(j * 9 + i);
+                units[18 + i][j] = uint8_t(((i / 3) * 3 + j / 3) * 9 + (i % 3) * 3 + j % 3);
+            }
+        for (int cell = 0; cell < 81; ++cell) {
+            int r = cell / 9, c = cell % 9, b = SudokuBoard::boxOf(r, c);
+            unitsOf[cell] = { uint8_t(r), uint8_t(9 + c), uint8_t(18 + b) };
+            posIn[cell] = { uint8_t(c), uint8_t(r), uint8_t((r % 3) * 3 + c % 3) };
+            int n = 0;
+            for (int other = 0; other < 81; ++other) {
+                int r2 = other / 9, c2 = other % 9;
+                if (other != cell && (r2 == r || c2 == c || SudokuBoard::boxOf(r2, c2) == b))
+                    peers[cell][n++] = uint8_t(other);
+            }
+        }
+    }
+};
+
+const GridTables& tables()
+{
+    static const GridTables t;
+    return t;
+}
+
+}
+
+CandidateGrid::CandidateGrid()
+    : cand_{}, value_{}, where_{}, nakedQueue_{}, hiddenQueue_{} {}
+
+const std::array<std::array<uint8_t, 9>, CandidateGrid::kUnits>& CandidateGrid::units() { return tables().units; }
+const std::array<std::array<uint8_t, 3>, 81>& CandidateGrid::unitsOf() { return tables().unitsOf; }
+const std::array<std::array<uint8_t, 20>, 81>& CandidateGrid::peers() { return tables().peers; }
+
+void CandidateGrid::load(const SudokuBoard& board)
+{
+    const auto& t = tables();
+    std::array<Mask, kUnits> placed{};
+    unsolved_ = 0;
+    broken_ = false;
+    where_ = {};
+    nakedQueue_ = {};
+    hiddenQueue_ = {};
+    for (int cell = 0; cell < 81; ++cell) value_[cell] = uint8_t(board.at(cell / 9, cell % 9));
+    computeCandidates(value_.data(), cand_.data());
+    for (int cell = 0; cell < 81; ++cell) {
+        if (value_[cell]) {
+            for (int u : t.unitsOf[cell]) placed[u] |= SudokuBoard::bit(value_[cell]);
+            continue;
+        }
+        const Mask m = cand_[cell];
+        ++unsolved_;
+        if (m == 0) broken_ = true;
+        else if (!(m & (m - 1))) nakedQueue_[cell >> 6] |= uint64_t(1) << (cell & 63);
+        for (int k = 0; k < 3; ++k)
+            for (Mask rest = m; rest; rest &= rest - 1)
+                where_[t.unitsOf[cell][k]][lowestBit(rest)] |= uint16_t(1u << t.posIn[cell][k]);
+    }
+    for (int u = 0; u < kUnits; ++u)
+        for (int d = 0; d < 9; ++d) {
+            const uint16_t w = where_[u][d];
+            if (placed[u] & (1u << d)) continue;
+            if (w == 0) broken_ = true;
+            else if (!(w & (w - 1))) hiddenQueue_[d] |= 1u << u;
+        }
+}
+
+// `cell` can no longer take digit index d: update the place sets of its three units.
+void CandidateGrid::dropPlace(int cell, int d)
+{
+    const auto& t = tables();
+    for (int k = 0; k < 3; ++k) {
+        int u = t.unitsOf[cell][k];
+        uint16_t w = where_[u][d];
+        const uint16_t b = uint16_t(1u << t.posIn[cell][k]);
+        if (!(w & b)) continue;
+        where_[u][d] = w &= uint16_t(~b);
+        if (w == 0) broken_ = true;
+        else if (!(w & (w - 1))) hiddenQueue_[d] |= 1u << u;
+    }
+}
+
+void CandidateGrid::place(int cell, int digit)
+{
+    const auto& t = tables();
+    const Mask m = SudokuBoard::bit(digit);
+    Mask rest = Mask(cand_[cell] & ~m);
+    value_[cell] = uint8_t(digit);
+    cand_[cell] = 0;
+    --unsolved_;
+    for (int u : t.unitsOf[cell]) where_[u][digit - 1] = 0;
+    for (; rest; rest &= rest - 1) dropPlace(cell, lowestBit(rest));
+    for (int p : t.peers[cell])
+        if (cand_[p] & m) eliminate(p, m);
+}
+
+bool CandidateGrid::eliminate(int cell, Mask digits)
+{
+    Mask m = Mask(cand_[cell] & digits);
+    if (value_[cell] || !m) return false;
+    const Mask left = cand_[cell] &= Mask(~m);
+    if (left == 0) broken_ = true;
+    else if (!(left & (left - 1))) nakedQueue_[cell >> 6] |= uint64_t(1) << (cell & 63);
+    for (; m; m &= m - 1) dropPlace(cell, lowestBit(m));
+    return true;
+}
+
+bool CandidateGrid::nextNakedSingle(int& cell, int& digit)
+{
+    for (int word = 0; word < 2; ++word)
+        while (uint64_t q = nakedQueue_[word]) {
+            int low = uint32_t(q) ? lowestBit(uint32_t(q)) : 32 + lowestBit(uint32_t(q >> 32));
+            nakedQueue_[word] = q & (q - 1);
+            int c = word * 64 + low;
+            const Mask m = cand_[c];
+            if (value_[c] || !m || (m & (m - 1))) continue;
+            cell = c;
+            digit = lowestBit(m) + 1;
+            return true;
+        }
+    return false;
+}
+
+bool CandidateGrid::nextHiddenSingle(int& cell, int& digit)
+{
+    const auto& t = tables();
+    for (int d = 0; d < 9; ++d)
+        while (uint32_t q = hiddenQueue_[d]) {
+            int u = lowestBit(q);
+            hiddenQueue_[d] = q & (q - 1);
+            const uint16_t w = where_[u][d];
+            if (!w || (w & (w - 1))) continue;
+            int c = t.units[u][lowestBit(w)];
+            if (value_[c]) continue;
+            cell = c;
+            digit = d + 1;
+            return true;
+        }
+    return false;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "SudokuBoard.h"
+
+// Candidate state for the 9x9 logical solver, kept across steps and updated
+// incrementally. Besides the per-cell candidate masks it tracks, for every unit and
+// digit, which of the unit's nine positions can still take the digit, and queues the
+// cells and unit/digit pairs that an update reduced to a single option so the single
+// strategies only look at what changed.
+//
+// Units are numbered rows 0-8, columns 9-17, boxes 18-26; position i of a unit is
+// units()[u][i]. Digits are 1-9, candidate bit (d - 1).
+class CandidateGrid {
+public:
+    using Mask = uint16_t;
+    static constexpr int kUnits = 27;
+
+    CandidateGrid();  // empty until load()
+    void load(const SudokuBoard& board);
+
+    int value(int cell) const { return value_[cell]; }
+    Mask candidates(int cell) const { return cand_[cell]; }
+    // Positions within unit `u` where `digit` can still go (0 once it is placed there).
+    uint16_t places(int u, int digit) const { return where_[u][digit - 1]; }
+    int unsolved() const { return unsolved_; }
+    // An update left an open cell without candidates or a digit without a place.
+    bool broken() const { return broken_; }
+
+    // Sets `cell` to `digit` and removes the digit from its peers.
+    void place(int cell, int digit);
+    // Removes `digits` from an open cell; returns true if any were present.
+    bool eliminate(int cell, Mask digits);
+
+    // Pop the next queued naked single (a cell with one candidate) or hidden single
+    // (a digit with one place in a unit), in row-major / digit-then-unit order.
+    bool nextNakedSingle(int& cell, int& digit);
+    bool nextHiddenSingle(int& cell, int& digit);
+
+    static const std::array<std::array<uint8_t, 9>, kUnits>& units();
+    static const std::array<std::array<uint8_t, 3>, 81>& unitsOf();
+    static const std::array<std::array<uint8_t, 20>, 81>& peers();
+    // True if distinct cells a and b share a row, column or box.
+    static bool sees(int a, int b)
+    {
+        return a != b && (a / 9 == b / 9 || a % 9 == b % 9 || SudokuBoard::boxOf(a / 9, a % 9) == SudokuBoard::boxOf(b / 9, b % 9));
+    }
+
+private:
+    std::array<Mask, 81> cand_;
+    std::array<uint8_t, 81> value_;
+    std::array<std::array<uint16_t, 9>, kUnits> where_;
+    std::array<uint64_t, 2> nakedQueue_;   // cell bits
+    std::array<uint32_t, 9> hiddenQueue_;  // per digit, unit bits
+    int unsolved_ = 81;
+    bool broken_ = false;
+
+    void dropPlace(int cell, int d);
+};
@@ -0,0 +1,236 @@
+#include "CandidateSolver.h"
+#include "Bits.h"
+
+namespace {
+
+template <int BR, int BC>
+struct Tables {
+    using Board = BasicBoard<BR, BC>;
+    static constexpr int N = Board::kSize;
+    static constexpr int kPeers = 2 * (N - 1) + (BR - 1) * (BC - 1);
+
+    uint16_t units[3 * N][N];
+    uint16_t peers[Board::kCells][kPeers];
+
+    Tables() {
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j) {
+                units[i][j] = uint16_t(i * N + j);
+                units[N + i][j] = uint16_t(j * N + i);
+                int r = (i / BR) * BR + j / BC, c = (i % BR) * BC + j % BC;
+                units[2 * N + i][j] = uint16_t(r * N + c);
+            }
+        for (int cell = 0; cell < Board::kCells; ++cell) {
+            int r = cell / N, c = cell % N, n = 0;
+            for (int other = 0; other < Board::kCells; ++other) {
+                int r2 = other / N, c2 = other % N;
+                if (other == cell) continue;
+                if (r2 == r || c2 == c || Board::boxOf(r2, c2) == Board::boxOf(r, c))
+                    peers[cell][n++] = uint16_t(other);
+            }
+        }
+    }
+};
+
+template <int BR, int BC>
+const Tables<BR, BC> kTables;
+
+}
+
+template <int BR, int BC>
+bool BasicCandidateSolver<BR, BC>::assign(State& s, int cell, int digit)
+{
+    if (!(s.cand[cell] & (1u << digit))) return false;
+    s.cand[cell] = Mask(1u << digit);
+
+    // Cells whose mask collapsed to a single bit but whose value is not yet recorded.
+    uint16_t queue[kCells];
+    int head = 0, tail = 0;
+    queue[tail++] = uint16_t(cell);
+    while (head < tail) {
+        int q = queue[head++];
+        if (s.value[q]) continue;
+        const Mask m = s.cand[q];
+        s.value[q] = uint8_t(lowestBit(m) + 1);
+        --s.unsolved;
+        for (int p : kTables<BR, BC>.peers[q]) {
+            Mask pm = s.cand[p];
+            if (!(pm & m)) continue;
+            pm &= Mask(~m);
+            if (pm == 0) return false;
+            s.cand[p] = pm;
+            if (!(pm & (pm - 1))) queue[tail++] = uint16_t(p);
+        }
+    }
+    return true;
+}
+
+template <int BR, int BC>
+bool BasicCandidateSolver<BR, BC>::propagate(State& s)
+{
+    bool progress = true;
+    while (progress && s.unsolved > 0) {
+        progress = false;
+        for (const auto& unit : kTables<BR, BC>.units) {
+            Mask once = 0, twice = 0, placed = 0;
+            for (int cell : unit) {
+                Mask m = s.cand[cell];
+                if (s.value[cell]) { placed |= m; continue; }
+                twice |= once & m;
+                once |= m;
+            }
+            if (Mask(once | placed) != Board::kAllDigits) return false;
+            Mask hidden = once & ~twice & ~placed;
+            while (hidden) {
+                int d = lowestBit(hidden);
+                hidden &= hidden - 1;
+                // An earlier assignment in this unit may already have placed d.
+                int target = -1;
+                bool done = false;
+                for (int cell : unit) {
+                    if (!(s.cand[cell] & (1u << d))) continue;
+                    if (s.value[cell]) done = true;
+                    else target = cell;
+                    break;
+                }
+                if (done) continue;
+                if (target < 0 || !assign(s, target, d)) return false;
+                progress = true;
+            }
+        }
+    }
+    return true;
+}
+
+template <int BR, int BC>
+typename BasicCandidateSolver<BR, BC>::Board BasicCandidateSolver<BR, BC>::toBoard(const State& s)
+{
+    Board board;
+    for (int cell = 0; cell < kCells; ++cell)
+        if (s.value[cell]) board.place(cell / kSize, cell % kSize, s.value[cell]);
+    return board;
+}
+
+// The open cell with fewest candidates. Forced cells never reach here: assign() has
+// already placed every cell that collapsed to one candidate.
+template <int BR, int BC>
+int BasicCandidateSolver<BR, BC>::branchCell(const State& s)
+{
+    int best = -1, bestCount = kSize + 1;
+    for (int cell = 0; cell < kCells; ++cell) {
+        if (s.value[cell]) continue;
+        int n = popCount(s.cand[cell]);
+        if (n < bestCount) { best = cell; bestCount = n; if (n == 2) break; }
+    }
+    return best;
+}
+
+template <int BR, int BC>
+void BasicCandidateSolver<BR, BC>::search(int depth)
+{
+    SUDOKU_STAT(if (stats_) stats_->node(depth));
+    // Dropping the limit to the current count unwinds every branch loop.
+    if (cancel_ && cancel_->poll()) { limit_ = count_; return; }
+    State& s = stack_[depth];
+    if (!propagate(s)) return;
+    if (s.unsolved == 0) {
+        if (++count_ == 1 && solution_) *solution_ = toBoard(s);
+        if (visitor_ && !(*visitor_)(toBoard(s))) limit_ = count_;
+        return;
+    }
+
+    const int best = branchCell(s);
+    State& next = stack_[depth + 1];
+    for (Mask m = s.cand[best]; m && count_ < limit_; m &= m - 1) {
+        next = s;
+        if (assign(next, best, lowestBit(m))) search(depth + 1);
+        SUDOKU_STAT(if (stats_) ++stats_->backtracks);
+    }
+}
+
+template <int BR, int BC>
+bool BasicCandidateSolver<BR, BC>::start(const Board& board)
+{
+    stack_.resize(kCells + 1);
+    State& s = stack_[0];
+    s.cand.fill(Board::kAllDigits);
+    s.value.fill(0);
+    s.unsolved = kCells;
+    bool consistent = true;
+    for (int cell = 0; cell < kCells && consistent; ++cell)
+        if (int v = board.at(cell / kSize, cell % kSize))
+            consistent = s.value[cell] == v || assign(s, cell, v - 1);
+    return consistent;
+}
+
+template <int BR, int BC>
+int BasicCandidateSolver<BR, BC>::solve(const Board& board, int limit, Board* solution)
+{
+    count_ = 0;
+    limit_ = limit;
+    solution_ = solution;
+    const bool consistent = start(board);
+    if (consistent && limit > 0) search(0);
+    solution_ = nullptr;
+    return consistent ? count_ : 0;
+}
+
+template <int BR, int BC>
+void BasicCandidateSolver<BR, BC>::splitSearch(int depth, int maxDepth, std::vector<Board>& out)
+{
+    State& s = stack_[depth];
+    if (!propagate(s)) return;
+    if (s.unsolved == 0 || depth == maxDepth) { out.push_back(toBoard(s)); return; }
+
+    const int best = branchCell(s);
+    State& next = stack_[depth + 1];
+    for (Mask m = s.cand[best]; m; m &= m - 1) {
+        next = s;
+        if (assign(next, best, lowestBit(m))) splitSearch(depth + 1, maxDepth, out);
+    }
+}
+
+template <int BR, int BC>
+bool BasicCandidateSolver<BR, BC>::split(const Board& board, int depth, std::vector<Board>& out)
+{
+    if (!start(board)) return false;
+    splitSearch(0, depth, out);
+    return true;
+}
+
+template <int BR, int BC>
+bool BasicCandidateSolver<BR, BC>::hasSolutionExcluding(const Board& board, int cell, int digit)
+{
+    count_ = 0;
+    limit_ = 1;
+    solution_ = nullptr;
+    stack_.resize(kCells + 1);
+
+    State& s = stack_[0];
+    s.unsolved = kCells;
+    for (int i = 0; i < kCells; ++i) {
+        int r = i / kSize, c = i % kSize, v = board.at(r, c);
+        s.value[i] = uint8_t(v);
+        s.cand[i] = v ? Board::bit(v) : board.candidates(r, c);
+        if (v) --s.unsolved;
+    }
+    if (s.value[cell]) return false;
+    s.cand[cell] &= Mask(~Board::bit(digit));
+
+    // The masks come straight from the board, so nothing has cascaded yet: place the
+    // naked singles now, or branchCell() could pick a pair over a forced cell.
+    for (int i = 0; i < kCells; ++i) {
+        const Mask m = s.cand[i];
+        if (m == 0) return false;
+        if (!s.value[i] && !(m & (m - 1)) && !assign(s, i, lowestBit(m))) return false;
+    }
+
+    search(0);
+    return count_ > 0;
+}
+
+template class BasicCandidateSolver<2, 2>;
+template class BasicCandidateSolver<2, 3>;
+template class BasicCandidateSolver<3, 3>;
+template class BasicCandidateSolver<4, 4>;
+template class BasicCandidateSolver<5, 5>;
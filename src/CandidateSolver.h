@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "CancelToken.h"
+#include "SearchStats.h"
+#include "SudokuBoard.h"
+
+// Depth-first search over N-bit candidate masks. Every placement eliminates its digit
+// from the peers (naked singles cascade through a queue), then each unit is scanned
+// for hidden singles. Branching always happens on the open cell with fewest candidates.
+template <int BoxRows, int BoxCols>
+class BasicCandidateSolver {
+public:
+    using Board = BasicBoard<BoxRows, BoxCols>;
+    using Mask = typename Board::Mask;
+    static constexpr int kSize = Board::kSize;
+    static constexpr int kCells = Board::kCells;
+    // Receives each solution; returning false stops the search.
+    using Visitor = std::function<bool(const Board&)>;
+
+    // Counts solutions up to `limit` and writes the first one found to `solution`.
+    // Returns 0 when the givens already conflict.
+    int solve(const Board& board, int limit, Board* solution = nullptr);
+
+    // Counters for subsequent calls are added to `stats` (nullptr detaches).
+    void setStats(SearchStats* stats) { stats_ = stats; }
+    // Searches poll `cancel` once per node and return early, with the solutions found
+    // so far, once it is cancelled (nullptr detaches).
+    void setCancel(CancelToken* cancel) { cancel_ = cancel; }
+    // Subsequent searches pass every solution they count to `visitor` (nullptr detaches).
+    void setVisitor(const Visitor* visitor) { visitor_ = visitor; }
+
+    // Expands the search `depth` branching levels and appends the board of every node
+    // left at that depth, forced placements included, to `out`. The solutions of `board`
+    // are split between those boards without overlap; a node solved above `depth` is
+    // appended as it is. Returns false when the givens conflict.
+    bool split(const Board& board, int depth, std::vector<Board>& out);
+
+    // True if the conflict-free `board` has a solution in which `cell` does not hold
+    // `digit`. The search starts straight from the board's occupancy masks.
+    bool hasSolutionExcluding(const Board& board, int cell, int digit);
+
+private:
+    struct State {
+        std::array<Mask, kCells> cand;
+        std::array<uint8_t, kCells> value;
+        int unsolved;
+    };
+
+    // One state per search depth, reused across calls so large boards stay off the stack.
+    std::vector<State> stack_;
+    SearchStats* stats_ = nullptr;
+    CancelToken* cancel_ = nullptr;
+    const Visitor* visitor_ = nullptr;
+    int count_ = 0;
+    int limit_ = 0;
+    Board* solution_ = nullptr;
+
+    static bool assign(State& s, int cell, int digit);
+    static bool propagate(State& s);
+    static Board toBoard(const State& s);
+    static int branchCell(const State& s);
+    // Loads the givens into stack_[0]; false when they conflict.
+    bool start(const Board& board);
+    void search(int depth);
+    void splitSearch(int depth, int maxDepth, std::vector<Board>& out);
+};
+
+extern template class BasicCandidateSolver<2, 2>;
+extern template class BasicCandidateSolver<2, 3>;
+extern template class BasicCandidateSolver<3, 3>;
+extern template class BasicCandidateSolver<4, 4>;
+extern template class BasicCandidateSolver<5, 5>;
+
+using CandidateSolver = BasicCandidateSolver<3, 3>;
@@ -0,0 +1,236 @@
+#include "Canonical.h"
+#include <algorithm>
+#include <vector>
+#include "Bits.h"
+
+namespace {
+
+// A grid ordering under construction: orientation and column order are fixed up
+// front, rows are appended one output row at a time.
+struct Partial {
+    std::array<uint8_t, 9> colOf;
+    std::array<uint8_t, 9> rowOf;
+    std::array<uint8_t, 10> label;  // input digit -> canonical digit, 0 = not seen yet
+    uint8_t next;                   // next canonical digit to hand out
+    uint8_t transpose;
+    uint16_t rowsUsed;              // input rows already placed
+};
+
+// The 1296 column orders that keep stacks together.
+const std::vector<std::array<uint8_t, 9>>& columnOrders()
+{
+    static const std::vector<std::array<uint8_t, 9>> orders = [] {
+        static constexpr uint8_t kPerm[6][3] = { { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 } };
+        std::vector<std::array<uint8_t, 9>> out;
+        out.reserve(1296);
+        for (const auto& stacks : kPerm)
+            for (const auto& a : kPerm)
+                for (const auto& b : kPerm)
+                    for (const auto& c : kPerm) {
+                        const uint8_t* inner[3] = { a, b, c };
+                        std::array<uint8_t, 9> order;
+                        for (int i = 0; i < 3; ++i)
+                            for (int j = 0; j < 3; ++j) order[3 * i + j] = uint8_t(3 * stacks[i] + inner[i][j]);
+                        out.push_back(order);
+                    }
+        return out;
+    }();
+    return orders;
+}
+
+}
+
+SudokuBoard GridTransform::apply(const SudokuBoard& board) const
+{
+    SudokuBoard out;
+    for (int r = 0; r < 9; ++r)
+        for (int c = 0; c < 9; ++c) {
+            const int v = transpose ? board.at(colOf[c], rowOf[r]) : board.at(rowOf[r], colOf[c]);
+            if (v) out.put(r, c, digit[v]);
+        }
+    return out;
+}
+
+SudokuBoard GridTransform::invert(const SudokuBoard& board) const
+{
+    std::array<uint8_t, 10> back{};
+    for (int d = 1; d <= 9; ++d) back[digit[d]] = uint8_t(d);
+    SudokuBoard out;
+    for (int r = 0; r < 9; ++r)
+        for (int c = 0; c < 9; ++c)
+            if (int v = board.at(r, c)) {
+                if (transpose) out.put(colOf[c], rowOf[r], back[v]);
+                else out.put(rowOf[r], colOf[c], back[v]);
+            }
+    return out;
+}
+
+void GridTransform::invert(int& row, int& col, int& num) const
+{
+    const int r = rowOf[row], c = colOf[col];
+    row = transpose ? c : r;
+    col = transpose ? r : c;
+    for (int d = 1; d <= 9; ++d)
+        if (digit[d] == num) { num = d; break; }
+}
+
+size_t CanonicalKeyHash::operator()(const CanonicalKey& k) const
+{
+    uint64_t h = 0x9e3779b97f4a7c15ull;
+    for (uint64_t w : k.words) {
+        h ^= w + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+        h *= 0xbf58476d1ce4e5b9ull;
+    }
+    return size_t(h ^ (h >> 31));
+}
+
+CanonicalForm canonicalize(const SudokuBoard& puzzle)
+{
+    uint8_t grid[2][81];
+    int stackClues[2][9][3] = {};
+    for (int r = 0; r < 9; ++r)
+        for (int c = 0; c < 9; ++c) {
+            const uint8_t v = uint8_t(puzzle.at(r, c));
+            grid[0][r * 9 + c] = grid[1][c * 9 + r] = v;
+            if (v) { ++stackClues[0][r][c / 3]; ++stackClues[1][c][r / 3]; }
+        }
+    // Output row 0 is labelled 1, 2, 3, ... left to right, so it is fixed by where its
+    // clues land. Each row's best placement (stacks by clue count, empties first within)
+    // as a 9-bit pattern, first column highest: only rows with the smallest one can lead.
+    int lead[2][9], minLead = 1 << 9;
+    for (int t = 0; t < 2; ++t)
+        for (int row = 0; row < 9; ++row) {
+            int n[3] = { stackClues[t][row][0], stackClues[t][row][1], stackClues[t][row][2] };
+            std::sort(n, n + 3);
+            int pattern = 0;
+            for (int k : n) pattern = (pattern << 3) | ((1 << k) - 1);
+            lead[t][row] = pattern;
+            minLead = std::min(minLead, pattern);
+        }
+
+    thread_local std::vector<Partial> cur, next;
+    std::array<uint8_t, 81> best;
+    std::array<uint8_t, 9> bestRow;
+
+    // Appends input row `row` as output row `depth` of `p`; keeps the result in `next`
+    // if it ties the best row so far, or restarts `next` with it if it beats it.
+    auto consider = [&](const Partial& p, int row, int depth) {
+        Partial q = p;
+        const uint8_t* in = grid[p.transpose] + row * 9;
+        std::array<uint8_t, 9> out;
+        int cmp = 0;
+        for (int c = 0; c < 9 && cmp <= 0; ++c) {
+            uint8_t x = 0;
+            if (const uint8_t v = in[q.colOf[c]]) {
+                if (!q.label[v]) q.label[v] = q.next++;
+                x = q.label[v];
+            }
+            out[c] = x;
+            if (cmp == 0 && x != bestRow[c]) cmp = x < bestRow[c] ? -1 : 1;
+        }
+        if (cmp > 0) return;
+        q.rowOf[depth] = uint8_t(row);
+        q.rowsUsed |= uint16_t(1u << row);
+        if (cmp < 0) { bestRow = out; next.clear(); }
+        if (next.size() < kMaxCanonicalTies) next.push_back(q);
+    };
+
+    // Output row 0: only column orders that put the row's empty cells first can win,
+    // so those are the only ones generated.
+    bestRow.fill(0xff);
+    next.clear();
+    for (uint8_t t = 0; t < 2; ++t)
+        for (int row = 0; row < 9; ++row) {
+            if (lead[t][row] != minLead) continue;
+            const uint8_t* in = grid[t] + row * 9;
+            for (const auto& order : columnOrders()) {
+                bool emptiesFirst = true;
+                for (int c = 1; c < 9 && emptiesFirst; ++c) {
+                    const bool prev = in[order[c - 1]] != 0, cur = in[order[c]] != 0;
+                    // Within a stack: empty before filled. Across stacks: fewer clues first.
+                    if (c % 3) emptiesFirst = !prev || cur;
+                    else {
+                        int a = 0, b = 0;
+                        for (int j = 0; j < 3; ++j) { a += in[order[c - 3 + j]] != 0; b += in[order[c + j]] != 0; }
+                        emptiesFirst = a <= b;
+                    }
+                }
+                if (emptiesFirst) consider({ order, {}, {}, 1, t, 0 }, row, 0);
+            }
+        }
+    for (int c = 0; c < 9; ++c) best[c] = bestRow[c];
+    std::swap(cur, next);
+
+    for (int depth = 1; depth < 9; ++depth) {
+        bestRow.fill(0xff);
+        next.clear();
+        for (const Partial& p : cur) {
+            // Output rows 3 and 6 open a new band; the others continue the current one.
+            uint16_t options = 0;
+            if (depth % 3 == 0) {
+                for (int band = 0; band < 3; ++band)
+                    if (!(p.rowsUsed & (7u << (3 * band)))) options |= uint16_t(7u << (3 * band));
+            }
+            else {
+                options = uint16_t((7u << (3 * (p.rowOf[depth - 1] / 3))) & ~p.rowsUsed);
+            }
+            for (int row = 0; row < 9; ++row)
+                if (options & (1u << row)) consider(p, row, depth);
+        }
+        for (int c = 0; c < 9; ++c) best[depth * 9 + c] = bestRow[c];
+        std::swap(cur, next);
+    }
+
+    CanonicalForm form;
+    const Partial& p = cur.front();
+    form.transform.transpose = p.transpose != 0;
+    form.transform.rowOf = p.rowOf;
+    form.transform.colOf = p.colOf;
+    form.transform.digit = p.label;
+    // Digits absent from the puzzle take the remaining labels in order.
+    uint8_t nextLabel = p.next;
+    for (int d = 1; d <= 9; ++d)
+        if (!form.transform.digit[d]) form.transform.digit[d] = nextLabel++;
+    for (int i = 0; i < 81; ++i) {
+        if (best[i]) form.board.put(i / 9, i % 9, best[i]);
+        form.key.words[i / 16] |= uint64_t(best[i]) << (4 * (i % 16));
+    }
+    return form;
+}
+
+uint64_t isomorphismSignature(const SudokuBoard& puzzle)
+{
+    std::array<uint8_t, 9> rows{}, cols{}, digits{};
+    std::array<uint8_t, 3> bands{}, stacks{};
+    std::array<uint8_t, 10> open{};
+    for (int r = 0; r < 9; ++r)
+        for (int c = 0; c < 9; ++c)
+            if (const int v = puzzle.at(r, c)) {
+                ++rows[r]; ++cols[c]; ++bands[r / 3]; ++stacks[c / 3]; ++digits[v - 1];
+            }
+            else ++open[popCount(puzzle.candidates(r, c))];
+    std::sort(rows.begin(), rows.end());
+    std::sort(cols.begin(), cols.end());
+    std::sort(bands.begin(), bands.end());
+    std::sort(stacks.begin(), stacks.end());
+    std::sort(digits.begin(), digits.end());
+    // A transpose swaps rows with columns and bands with stacks.
+    if (cols < rows) { std::swap(rows, cols); std::swap(bands, stacks); }
+    else if (cols == rows && stacks < bands) std::swap(bands, stacks);
+
+    uint64_t h = 0x9e3779b97f4a7c15ull;
+    auto mix = [&h](const uint8_t* p, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            h ^= p[i];
+            h *= 0x100000001b3ull;
+        }
+        h ^= h >> 29;
+    };
+    mix(rows.data(), rows.size());
+    mix(cols.data(), cols.size());
+    mix(bands.data(), bands.size());
+    mix(stacks.data(), stacks.size());
+    mix(digits.data(), digits.size());
+    mix(open.data(), open.size());
+    return h ^ (h >> 32);
+}
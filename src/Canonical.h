@@ -0,0 +1,56 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "SudokuBoard.h"
+
+// One element of the 9x9 Sudoku symmetry group (optional transpose, then band, row
+// within band, stack and column within stack permutations) combined with a digit
+// relabelling. apply() maps a board into the output frame, invert() maps it back.
+struct GridTransform {
+    bool transpose = false;
+    std::array<uint8_t, 9> rowOf{};   // output row r is input row rowOf[r]
+    std::array<uint8_t, 9> colOf{};   // output column c is input column colOf[c]
+    std::array<uint8_t, 10> digit{};  // digit[d] = output digit for input digit d; digit[0] = 0
+
+    SudokuBoard apply(const SudokuBoard& board) const;
+    SudokuBoard invert(const SudokuBoard& board) const;
+    // Maps one placement in the output frame back to the input frame.
+    void invert(int& row, int& col, int& num) const;
+};
+
+// 4 bits per cell of a canonical grid, usable as a hash key.
+struct CanonicalKey {
+    std::array<uint64_t, 6> words{};
+
+    bool operator==(const CanonicalKey& o) const { return words == o.words; }
+    bool operator!=(const CanonicalKey& o) const { return words != o.words; }
+};
+
+struct CanonicalKeyHash {
+    size_t operator()(const CanonicalKey& k) const;
+};
+
+struct CanonicalForm {
+    SudokuBoard board;          // the minimal representative
+    CanonicalKey key;
+    GridTransform transform;    // maps the input puzzle onto `board`
+};
+
+// Maps a puzzle to the lexicographically smallest grid (row-major, empty cells as 0)
+// reachable under the 3,359,232 grid symmetries and digit relabelling, so isomorphic
+// puzzles share a key. The search extends row by row and keeps only the orderings tied
+// for the smallest prefix. Boards far too sparse to be proper puzzles can keep more
+// than kMaxCanonicalTies orderings tied; only the first ones are followed, so for
+// those the result is neither guaranteed minimal nor symmetry-invariant: the key then
+// depends on the input orientation, and isomorphic copies of such a board miss each
+// other in PuzzleCache.
+constexpr size_t kMaxCanonicalTies = 1 << 16;
+
+CanonicalForm canonicalize(const SudokuBoard& puzzle);
+
+// Hash of properties every isomorphic copy of `puzzle` shares: the sorted clue counts of
+// the rows, columns, bands and stacks, the sorted digit frequencies and how many open
+// cells have each candidate count. Equal for isomorphic puzzles, rarely equal
+// otherwise, and computed in about a microsecond.
+uint64_t isomorphismSignature(const SudokuBoard& puzzle);
@@ -0,0 +1,139 @@
+#include "DlxSolver.h"
+#include <algorithm>
+
+template <int BR, int BC>
+BasicDlxSolver<BR, BC>::BasicDlxSolver()
+    : left_(kNodes), right_(kNodes), up_(kNodes), down_(kNodes), col_(kNodes), rowOf_(kNodes),
+      size_(kColumns + 1), firstNode_(kRows), partial_(kCells), covered_(4 * kCells), isCovered_(kColumns + 1)
+{
+    for (int c = 0; c <= kColumns; ++c) {
+        left_[c] = c == 0 ? kColumns : c - 1;
+        right_[c] = c == kColumns ? 0 : c + 1;
+        up_[c] = down_[c] = col_[c] = c;
+        rowOf_[c] = -1;
+        size_[c] = 0;
+    }
+
+    int node = kColumns + 1;
+    for (int row = 0; row < kRows; ++row) {
+        int cell = row / kSize, r = cell / kSize, c = cell % kSize, d = row % kSize;
+        const int cols[4] = {
+            1 + cell,
+            1 + kCells + r * kSize + d,
+            1 + 2 * kCells + c * kSize + d,
+            1 + 3 * kCells + Board::boxOf(r, c) * kSize + d,
+        };
+        firstNode_[row] = node;
+        for (int k = 0; k < 4; ++k, ++node) {
+            int h = cols[k];
+            col_[node] = h;
+            rowOf_[node] = row;
+            up_[node] = up_[h]; down_[node] = h;
+            down_[up_[h]] = node; up_[h] = node;
+            ++size_[h];
+            left_[node] = k == 0 ? node + 3 : node - 1;
+            right_[node] = k == 3 ? node - 3 : node + 1;
+        }
+    }
+}
+
+template <int BR, int BC>
+void BasicDlxSolver<BR, BC>::cover(int c)
+{
+    right_[left_[c]] = right_[c];
+    left_[right_[c]] = left_[c];
+    for (int i = down_[c]; i != c; i = down_[i])
+        for (int j = right_[i]; j != i; j = right_[j]) {
+            up_[down_[j]] = up_[j];
+            down_[up_[j]] = down_[j];
+            --size_[col_[j]];
+        }
+}
+
+template <int BR, int BC>
+void BasicDlxSolver<BR, BC>::uncover(int c)
+{
+    for (int i = up_[c]; i != c; i = up_[i])
+        for (int j = left_[i]; j != i; j = left_[j]) {
+            ++size_[col_[j]];
+            up_[down_[j]] = j;
+            down_[up_[j]] = j;
+        }
+    right_[left_[c]] = c;
+    left_[right_[c]] = c;
+}
+
+template <int BR, int BC>
+void BasicDlxSolver<BR, BC>::search(int depth)
+{
+    SUDOKU_STAT(if (stats_) stats_->node(depth));
+    // Dropping the limit to the current count unwinds every branch loop.
+    if (cancel_ && cancel_->poll()) { limit_ = count_; return; }
+    if (right_[0] == 0) {
+        if (++count_ == 1 && solution_) {
+            *solution_ = *givens_;
+            for (int k = 0; k < depth; ++k) {
+                int row = partial_[k], cell = row / kSize;
+                solution_->place(cell / kSize, cell % kSize, row % kSize + 1);
+            }
+        }
+        return;
+    }
+
+    int best = right_[0];
+    for (int c = right_[best]; c != 0; c = right_[c])
+        if (size_[c] < size_[best]) best = c;
+    if (size_[best] == 0) return;
+
+    cover(best);
+    for (int r = down_[best]; r != best && count_ < limit_; r = down_[r]) {
+        partial_[depth] = rowOf_[r];
+        for (int j = right_[r]; j != r; j = right_[j]) cover(col_[j]);
+        search(depth + 1);
+        for (int j = left_[r]; j != r; j = left_[j]) uncover(col_[j]);
+        SUDOKU_STAT(if (stats_) ++stats_->backtracks);
+    }
+    uncover(best);
+}
+
+template <int BR, int BC>
+int BasicDlxSolver<BR, BC>::solve(const Board& board, int limit, Board* solution)
+{
+    count_ = 0;
+    limit_ = limit;
+    givens_ = &board;
+    solution_ = solution;
+
+    // Select the rows of the givens. A given whose constraint column is already gone
+    // conflicts with an earlier one; covered_ remembers how far to roll back.
+    int nCovered = 0;
+    bool consistent = true;
+    std::fill(isCovered_.begin(), isCovered_.end(), 0);
+    for (int cell = 0; cell < kCells && consistent; ++cell) {
+        int v = board.at(cell / kSize, cell % kSize);
+        if (v == 0) continue;
+        int first = firstNode_[cell * kSize + v - 1];
+        for (int k = 0; k < 4; ++k)
+            if (isCovered_[col_[first + k]]) { consistent = false; break; }
+        if (!consistent) break;
+        for (int k = 0; k < 4; ++k) {
+            int h = col_[first + k];
+            cover(h);
+            isCovered_[h] = 1;
+            covered_[nCovered++] = h;
+        }
+    }
+
+    if (consistent && limit > 0) search(0);
+
+    while (nCovered > 0) uncover(covered_[--nCovered]);
+    givens_ = nullptr;
+    solution_ = nullptr;
+    return consistent ? count_ : 0;
+}
+
+template class BasicDlxSolver<2, 2>;
+template class BasicDlxSolver<2, 3>;
+template class BasicDlxSolver<3, 3>;
+template class BasicDlxSolver<4, 4>;
+template class BasicDlxSolver<5, 5>;
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "CancelToken.h"
+#include "SearchStats.h"
+#include "SudokuBoard.h"
+
+// Exact-cover solver (Algorithm X with dancing links) over the 4*N*N Sudoku constraints:
+// cell filled, digit in row, digit in column, digit in box. The full N^3-row matrix is
+// built once; each call covers the givens, searches, and restores the links on exit.
+template <int BoxRows, int BoxCols>
+class BasicDlxSolver {
+public:
+    using Board = BasicBoard<BoxRows, BoxCols>;
+    static constexpr int kSize = Board::kSize;
+    static constexpr int kCells = Board::kCells;
+
+    BasicDlxSolver();
+
+    // Counts solutions up to `limit` and writes the first one found to `solution`.
+    // Returns 0 when the givens already conflict.
+    int solve(const Board& board, int limit, Board* solution = nullptr);
+
+    // Counters for subsequent calls are added to `stats` (nullptr detaches).
+    void setStats(SearchStats* stats) { stats_ = stats; }
+    // Searches poll `cancel` once per node and return early, with the solutions found
+    // so far, once it is cancelled (nullptr detaches).
+    void setCancel(CancelToken* cancel) { cancel_ = cancel; }
+
+private:
+    static constexpr int kColumns = 4 * kCells;
+    static constexpr int kRows = kCells * kSize;
+    static constexpr int kNodes = 1 + kColumns + kRows * 4;
+
+    std::vector<int> left_, right_, up_, down_, col_, rowOf_;
+    std::vector<int> size_, firstNode_, partial_, covered_;
+    std::vector<char> isCovered_;
+
+    SearchStats* stats_ = nullptr;
+    CancelToken* cancel_ = nullptr;
+    int count_ = 0;
+    int limit_ = 0;
+    const Board* givens_ = nullptr;
+    Board* solution_ = nullptr;
+
+    void cover(int c);
+    void uncover(int c);
+    void search(int depth);
+};
+
+extern template class BasicDlxSolver<2, 2>;
+extern template class BasicDlxSolver<2, 3>;
+extern template class BasicDlxSolver<3, 3>;
+extern template class BasicDlxSolver<4, 4>;
+extern template class BasicDlxSolver<5, 5>;
+
+using DlxSolver = BasicDlxSolver<3, 3>;
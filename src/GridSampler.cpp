@@ -0,0 +1,118 @@
+#include "GridSampler.h"
+#include "CandidateSolver.h"
+
+namespace {
+
+constexpr uint8_t kPerm[6][3] = { { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 } };
+
+// Four base-6 digits of `code`: the order of the three bands (or stacks) and the
+// order of the lines inside each.
+void decodeLines(uint64_t& code, uint8_t* lineOf)
+{
+    const uint8_t* outer = kPerm[code % 6];
+    code /= 6;
+    for (int b = 0; b < 3; ++b) {
+        const uint8_t* inner = kPerm[code % 6];
+        code /= 6;
+        for (int i = 0; i < 3; ++i) lineOf[3 * b + i] = uint8_t(3 * outer[b] + inner[i]);
+    }
+}
+
+// Swaps lines `a` and `b` of one band (or stack) along the cycle through position
+// `start`: the cells at `start` are exchanged, which duplicates a digit in each line, so
+// the exchange continues at the position that held the incoming digit until the cycle
+// closes. Each swap stays within one column (row) and one box, so columns and boxes
+// keep their digits. `line` and `step` are the strides between lines and along a line.
+void cycleSwap(uint8_t* cells, int a, int b, int start, int line, int step)
+{
+    uint8_t* x = cells + a * line;
+    uint8_t* y = cells + b * line;
+    uint8_t posInX[10];
+    for (int k = 0; k < 9; ++k) posInX[x[k * step]] = uint8_t(k);
+    const uint8_t first = x[start * step];
+    for (int k = start;;) {
+        const uint8_t incoming = y[k * step];
+        y[k * step] = x[k * step];
+        x[k * step] = incoming;
+        if (incoming == first) break;
+        k = posInX[incoming];
+    }
+}
+
+}
+
+GridSampler::GridSampler(uint64_t seed, size_t templates, int swaps)
+    : swaps_(swaps)
+{
+    Rng rng(seed);
+    CandidateSolver solver;
+    templates_.resize(templates);
+    for (auto& t : templates_) {
+        // The diagonal boxes do not constrain each other, so any filling completes.
+        SudokuBoard b, solved;
+        for (int d = 0; d < 9; d += 3) {
+            std::array<int, 9> nums{ 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+            rng.shuffle(nums.data(), nums.size());
+            for (int k = 0; k < 9; ++k) b.place(d + k / 3, d + k % 3, nums[k]);
+        }
+        solver.solve(b, 1, &solved);
+        for (int i = 0; i < 81; ++i) t[i] = uint8_t(solved.at(i / 9, i % 9));
+    }
+}
+
+const GridSampler& GridSampler::shared()
+{
+    static const GridSampler sampler(0x67726964ull);
+    return sampler;
+}
+
+void GridSampler::sample(Rng& rng, SudokuBoard& out) const
+{
+    const size_t index = rng.below(uint32_t(templates_.size()));
+    uint8_t cells[81];
+    transform(index, rng(), cells);
+    for (int i = 0; i < swaps_; ++i) {
+        // Alternate rows and columns: one of the 3 x 3 line pairs and a start position.
+        const int pick = int(rng.below(81)), pair = pick / 9, start = pick % 9;
+        const int a = pair / 3 * 3 + pair % 3, b = pair / 3 * 3 + (pair + 1) % 3;
+        if (i & 1) cycleSwap(cells, a, b, start, 1, 9);
+        else cycleSwap(cells, a, b, start, 9, 1);
+    }
+    out.setSolved(cells);
+}
+
+void GridSampler::grid(size_t index, uint64_t code, SudokuBoard& out) const
+{
+    uint8_t cells[81];
+    transform(index, code, cells);
+    out.setSolved(cells);
+}
+
+void GridSampler::transform(size_t index, uint64_t code, uint8_t cells[81]) const
+{
+    code %= kVariants;
+    uint8_t rowOf[9], colOf[9];
+    const bool transpose = code & 1;
+    code >>= 1;
+    decodeLines(code, rowOf);
+    decodeLines(code, colOf);
+    // The remaining 0 .. 9!-1 is a Lehmer code for the relabelling.
+    uint32_t relabel = uint32_t(code);
+    uint8_t pool[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 }, digit[10] = {};
+    for (uint32_t d = 1, left = 9; d <= 9; ++d, --left) {
+        const uint32_t k = relabel % left;
+        relabel /= left;
+        digit[d] = pool[k];
+        for (uint32_t j = k; j + 1 < left; ++j) pool[j] = pool[j + 1];
+    }
+
+    // Template offset of each output row and column; a transpose swaps their strides.
+    const int rowStride = transpose ? 1 : 9, colStride = transpose ? 9 : 1;
+    int colAt[9];
+    for (int c = 0; c < 9; ++c) colAt[c] = colOf[c] * colStride;
+    const uint8_t* t = templates_[index].data();
+    for (int r = 0; r < 9; ++r) {
+        const uint8_t* row = t + rowOf[r] * rowStride;
+        for (int c = 0; c < 9; ++c) cells[r * 9 + c] = digit[row[colAt[c]]];
+    }
+}
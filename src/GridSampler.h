@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Rng.h"
+#include "SudokuBoard.h"
+
+// Source of random filled 9x9 grids without a search per grid. A pool of template
+// grids is solved once up front; each sample takes a random template through a random
+// element of the grid symmetry group (transpose, band, row-in-band, stack and
+// column-in-stack permutations) and a random digit relabelling, about 1.2e12 variants
+// per template, and then a short random walk of cycle swaps. A cycle swap exchanges
+// the digits of two rows of one band (or two columns of one stack) along a closed cycle
+// of columns (rows); the result is still a valid grid but in general not an isomorphic
+// one, so samples are not confined to the orbits of the templates.
+//
+// Bias: the walk starts from a fixed pool and is short, so samples are uniform-ish
+// rather than uniform over all 6.67e21 grids. More templates and more swaps per sample
+// shrink the bias at the cost of start-up time and time per sample respectively; the
+// pool's seed chooses the starting grids. Immutable after construction and safe to
+// share between threads.
+class GridSampler {
+public:
+    static constexpr size_t kDefaultTemplates = 1024;
+    static constexpr int kDefaultSwaps = 16;
+    // Transform codes per template: 2 * 6^8 line permutations times 9! relabellings.
+    static constexpr uint64_t kVariants = 2ull * 1679616ull * 362880ull;
+
+    explicit GridSampler(uint64_t seed = 0, size_t templates = kDefaultTemplates, int swaps = kDefaultSwaps);
+
+    // Built on first use from a fixed seed with the defaults, so seeded generation stays
+    // reproducible. Callers wanting another pool size, seed or walk length build their
+    // own sampler (see Service::setGridSampler).
+    static const GridSampler& shared();
+
+    size_t templates() const { return templates_.size(); }
+    int swaps() const { return swaps_; }
+
+    // A random grid: one Rng draw picks the template, one the transform and one each
+    // cycle swap.
+    void sample(Rng& rng, SudokuBoard& out) const;
+    // Template `index` under transform `code` (any value; reduced mod kVariants), without
+    // the walk. Walking code over [0, kVariants) enumerates the template's orbit, each
+    // grid as often as the template has automorphisms.
+    void grid(size_t index, uint64_t code, SudokuBoard& out) const;
+
+private:
+    std::vector<std::array<uint8_t, 81>> templates_;
+    int swaps_;
+
+    void transform(size_t index, uint64_t code, uint8_t cells[81]) const;
+};
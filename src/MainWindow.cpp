@@ -9,8 +9,24 @@
 #include <QSignalBlocker>
 #include <QTimer>
 #include <array>
+#include <chrono>
+#include "SimdKernels.h"
 #include "SudokuBoard.h"
 
+namespace {
+
+// Background solves give up after this long; hard but proper puzzles take milliseconds.
+constexpr auto kJobTimeout = std::chrono::seconds(10);
+
+const QString kConflictColor = "#ffcccb";
+
+bool inUnits(uint32_t units, int r, int c)
+{
+    return units & ((1u << r) | (1u << (9 + c)) | (1u << (18 + SudokuBoard::boxOf(r, c))));
+}
+
+}
+
 QString MainWindow::baseCellStyle(int r, int c, bool isGiven) {
     QString s =
         "QLineEdit {"
@@ -28,16 +44,6 @@ QString MainWindow::baseCellStyle(int r, int c, bool isGiven) {
     return s;
 }
 
-bool MainWindow::hasDuplicates(const std::array<int, 9>& arr) {
-    bool seen[10] = { false };
-    for (int x : arr) {
-        if (x == 0) continue;
-        if (seen[x]) return true;
-        seen[x] = true;
-    }
-    return false;
-}
-
 MainWindow::MainWindow(QWidget* parent)
     : QWidget(parent)
 {
@@ -51,8 +57,12 @@ MainWindow::MainWindow(QWidget* parent)
     difficultyLabel = new QLabel(this);
     livesLabel->setStyleSheet("QLabel { font-weight: 600; }");
     difficultyLabel->setStyleSheet("QLabel { color: #333; }");
+    statusLabel = new QLabel(this);
+    statusLabel->setStyleSheet("QLabel { color: #666; }");
     infoBar->addWidget(livesLabel);
     infoBar->addStretch(1);
+    infoBar->addWidget(statusLabel);
+    infoBar->addStretch(1);
     infoBar->addWidget(difficultyLabel);
     mainLayout->addLayout(infoBar);
 
@@ -75,9 +85,9 @@ MainWindow::MainWindow(QWidget* parent)
             cell->setFixedSize(48, 48);
             cell->setProperty("row", r);
             cell->setProperty("col", c);
-            cell->setStyleSheet(baseCellStyle(r, c));
             connect(cell, &QLineEdit::editingFinished, this, &MainWindow::onCellEdited);
             cells[r][c] = cell;
+            restyleCell(r, c);
             gridLayout->addWidget(cell, r, c);
         }
     }
@@ -113,11 +123,58 @@ MainWindow::MainWindow(QWidget* parent)
     connect(checkButton, &QPushButton::clicked, this, &MainWindow::onCheckClicked);
     connect(difficultyBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onDifficultyChanged);
 
+    progressTimer = new QTimer(this);
+    progressTimer->setInterval(100);
+    connect(progressTimer, &QTimer::timeout, this, [this]() { if (job && job->nodes()) emit searchProgress(job->nodes()); });
+    connect(this, &MainWindow::searchProgress, this, &MainWindow::onSearchProgress);
+
     resize(540, 660);
     resetGame(currentDifficulty);
 }
 
-MainWindow::~MainWindow() = default;
+MainWindow::~MainWindow()
+{
+    cancelJob();
+}
+
+void MainWindow::startJob(const QString& status, Job work)
+{
+    cancelJob();
+    auto token = std::make_shared<CancelToken>();
+    token->setTimeout(kJobTimeout);
+    job = token;
+    const quint64 id = ++jobId;
+    jobStatus = status;
+    statusLabel->setText(status);
+    progressTimer->start();
+    worker = std::thread([this, token, id, work = std::move(work)]() {
+        auto done = work(*token);
+        // Queued back to the UI thread; dropped if a newer job started in the meantime
+        // or the window is gone.
+        QMetaObject::invokeMethod(this, [this, id, done = std::move(done)]() {
+            if (id != jobId) return;
+            progressTimer->stop();
+            statusLabel->clear();
+            job.reset();
+            if (done) done();
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::cancelJob()
+{
+    if (job) job->cancel();
+    // A cancelled search unwinds within a poll interval, so this join is short.
+    if (worker.joinable()) worker.join();
+    job.reset();
+    progressTimer->stop();
+    statusLabel->clear();
+}
+
+void MainWindow::onSearchProgress(quint64 nodes)
+{
+    statusLabel->setText(QString("%1 %2 nodes").arg(jobStatus).arg(nodes));
+}
 
 void MainWindow::refreshInfo() {
     difficultyLabel->setText("Difficulty: " + difficultyBox->currentText());
@@ -130,21 +187,29 @@ QString MainWindow::renderLives() const {
     return s;
 }
 
-void MainWindow::resetGame(int difficulty) {
+void MainWindow::resetGame(int difficulty, const QString& doneMessage) {
     currentDifficulty = difficulty;
-    auto board = service.generatePuzzle(currentDifficulty);
-    SudokuBoard sb; sb.setGrid(board);
+    // Usually a pop from the generator's pool; generating on a dry pool takes a few
+    // milliseconds, so the job is not cancellable midway, only superseded.
+    startJob("Generating...", [this, difficulty, doneMessage](CancelToken&) -> std::function<void()> {
+        const SudokuBoard puzzle = generator.next(difficulty);
+        auto puzzleTrace = std::make_shared<SolveTrace>(SolveTrace::record(puzzle));
+        return [this, puzzle, puzzleTrace, doneMessage]() {
+            startGame(puzzle, std::move(*puzzleTrace));
+            if (!doneMessage.isEmpty()) showMessage(doneMessage);
+        };
+    });
+}
+
+void MainWindow::startGame(const SudokuBoard& sb, SolveTrace puzzleTrace) {
+    trace = std::move(puzzleTrace);
+    service.setTrace(&trace);
     service.loadBoard(sb);
-    for (int r = 0; r < 9; ++r) {
-        for (int c = 0; c < 9; ++c) {
-            QSignalBlocker b1(cells[r][c]);
-            if (board[r][c] == 0) cells[r][c]->clear();
-            else cells[r][c]->setText(QString::number(board[r][c]));
-            bool given = (board[r][c] != 0);
-            cells[r][c]->setReadOnly(given);
-            cells[r][c]->setStyleSheet(baseCellStyle(r, c, given));
-        }
-    }
+    model = sb;
+    for (int r = 0; r < 9; ++r)
+        for (int c = 0; c < 9; ++c) cells[r][c]->setReadOnly(model.at(r, c) != 0);
+    showModel();
+    clearMarks();
     usedHints = 0;
     lives = 3;
     hintButton->setText("Hint (3 left)");
@@ -165,41 +230,51 @@ void MainWindow::loseLifeAndMaybeRestart() {
 
 void MainWindow::onSolveClicked()
 {
-    SudokuBoard sb; sb.setGrid(loadBoardFromUI());
-    service.loadBoard(sb);
-    if (service.solve()) {
-        loadBoardToUI(service.getBoard().getGrid());
-        for (int r = 0; r < 9; ++r)
-            for (int c = 0; c < 9; ++c) {
-                QSignalBlocker b(cells[r][c]);
-                cells[r][c]->setReadOnly(true);
-                cells[r][c]->setStyleSheet(baseCellStyle(r, c, true));
-            }
-        showMessage("Solved!");
-    }
-    else {
-        showMessage("No solution exists for the current board.");
-    }
+    const SudokuBoard sb = model;
+    const Engine engine = service.engine();
+    startJob("Solving...", [this, sb, engine](CancelToken& token) -> std::function<void()> {
+        // The worker has its own Service; the UI thread keeps using `service`.
+        Service work(engine);
+        work.setCancel(&token);
+        work.loadBoard(sb);
+        const bool solved = work.solve();
+        if (token.timedOut()) {
+            const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(kJobTimeout).count();
+            return [this, seconds]() { showMessage(QString("Gave up after %1 seconds without a solution.").arg(seconds)); };
+        }
+        if (token.cancelled()) return nullptr;
+        const SudokuBoard solution = work.getBoard();
+        return [this, solved, solution]() {
+            if (!solved) { showMessage("No solution exists for the current board."); return; }
+            service.loadBoard(solution);
+            model = solution;
+            for (int r = 0; r < 9; ++r)
+                for (int c = 0; c < 9; ++c) cells[r][c]->setReadOnly(true);
+            showModel();
+            clearMarks();
+            showMessage("Solved!");
+        };
+    });
 }
 
 void MainWindow::onGenerateClicked()
 {
     int difficulty = difficultyBox->currentIndex() + 1;
-    resetGame(difficulty);
-    showMessage("New puzzle generated.");
+    resetGame(difficulty, "New puzzle generated.");
 }
 
 void MainWindow::onHintClicked()
 {
     if (usedHints >= 3) { showMessage("No hints left!"); return; }
-    SudokuBoard sb; sb.setGrid(loadBoardFromUI());
-    service.loadBoard(sb);
+    service.loadBoard(model);
     auto [row, col, value] = service.getHint();
     if (row == -1) { showMessage("No simple hint available!"); return; }
+    model.put(row, col, value);
     {
         QSignalBlocker b1(cells[row][col]);
         cells[row][col]->setText(QString::number(value));
     }
+    if (conflictUnits) refreshConflicts();
     highlightCell(row, col, "#dcedc8");
     usedHints++;
     hintButton->setText(QString("Hint (%1 left)").arg(3 - usedHints));
@@ -207,13 +282,12 @@ void MainWindow::onHintClicked()
 
 void MainWindow::onClearClicked()
 {
+    cancelJob();
+    model = SudokuBoard();
     for (int r = 0; r < 9; ++r)
-        for (int c = 0; c < 9; ++c) {
-            QSignalBlocker b1(cells[r][c]);
-            cells[r][c]->clear();
-            cells[r][c]->setReadOnly(false);
-            cells[r][c]->setStyleSheet(baseCellStyle(r, c));
-        }
+        for (int c = 0; c < 9; ++c) cells[r][c]->setReadOnly(false);
+    showModel();
+    clearMarks();
     usedHints = 0;
     lives = 3;
     hintButton->setText("Hint (3 left)");
@@ -222,51 +296,15 @@ void MainWindow::onClearClicked()
 
 void MainWindow::onCheckClicked()
 {
-    auto board = loadBoardFromUI();
+    for (auto& row : marks)
+        for (auto& color : row) color.clear();
+    conflictUnits = 0;
+    refreshConflicts();
+    // Cells that lost their edit or hint colour; unchanged cells are skipped.
     for (int r = 0; r < 9; ++r)
-        for (int c = 0; c < 9; ++c) {
-            QSignalBlocker b1(cells[r][c]);
-            bool given = cells[r][c]->isReadOnly();
-            cells[r][c]->setStyleSheet(baseCellStyle(r, c, given));
-        }
-
-    bool ok = true;
+        for (int c = 0; c < 9; ++c) restyleCell(r, c);
 
-    for (int r = 0; r < 9; ++r) {
-        std::array<int, 9> row{};
-        for (int c = 0; c < 9; ++c) row[c] = board[r][c];
-        if (hasDuplicates(row)) {
-            ok = false;
-            for (int c = 0; c < 9; ++c) highlightCell(r, c, "#ffcccb");
-        }
-    }
-
-    for (int c = 0; c < 9; ++c) {
-        std::array<int, 9> col{};
-        for (int r = 0; r < 9; ++r) col[r] = board[r][c];
-        if (hasDuplicates(col)) {
-            ok = false;
-            for (int r = 0; r < 9; ++r) highlightCell(r, c, "#ffcccb");
-        }
-    }
-
-    for (int br = 0; br < 3; ++br) {
-        for (int bc = 0; bc < 3; ++bc) {
-            std::array<int, 9> box{};
-            int idx = 0;
-            for (int r = br * 3; r < br * 3 + 3; ++r)
-                for (int c = bc * 3; c < bc * 3 + 3; ++c)
-                    box[idx++] = board[r][c];
-            if (hasDuplicates(box)) {
-                ok = false;
-                for (int r = br * 3; r < br * 3 + 3; ++r)
-                    for (int c = bc * 3; c < bc * 3 + 3; ++c)
-                        highlightCell(r, c, "#ffcccb");
-            }
-        }
-    }
-
-    if (!ok) loseLifeAndMaybeRestart();
+    if (conflictUnits) loseLifeAndMaybeRestart();
     else showMessage("No mistakes found.");
 }
 
@@ -284,20 +322,20 @@ void MainWindow::onCellEdited()
     int c = cell->property("col").toInt();
 
     const QString t = cell->text().trimmed();
-    if (t.isEmpty()) {
-        cell->setStyleSheet(baseCellStyle(r, c, false));
+    const int val = t.isEmpty() ? 0 : t.toInt();
+    if (val == model.at(r, c)) { editingGuard = false; return; }
+    // The unit masks answer the conflict check; the rest of the grid is not read.
+    model.put(r, c, 0);
+    const bool ok = val == 0 || model.isSafe(r, c, val);
+    if (val) model.put(r, c, val);
+    if (conflictUnits) refreshConflicts();
+
+    if (val == 0) {
+        highlightCell(r, c, QString());
         editingGuard = false;
-        return;
     }
-
-    int val = t.toInt();
-    auto board = loadBoardFromUI();
-    board[r][c] = 0;
-    SudokuBoard sb; sb.setGrid(board);
-    service.loadBoard(sb);
-
-    if (!service.isValidMove(r, c, val)) {
-        highlightCell(r, c, "#ffcccb");
+    else if (!ok) {
+        highlightCell(r, c, kConflictColor);
         QTimer::singleShot(0, this, [this]() { loseLifeAndMaybeRestart(); editingGuard = false; });
     }
     else {
@@ -312,42 +350,67 @@ void MainWindow::onDifficultyChanged(int idx)
     resetGame(idx + 1);
 }
 
-void MainWindow::loadBoardToUI(const std::vector<std::vector<int>>& board)
+void MainWindow::showModel()
 {
     for (int r = 0; r < 9; ++r)
         for (int c = 0; c < 9; ++c) {
+            const int v = model.at(r, c);
+            const QString text = v ? QString::number(v) : QString();
+            if (cells[r][c]->text() == text) continue;
             QSignalBlocker b1(cells[r][c]);
-            if (board[r][c] == 0)
-                cells[r][c]->clear();
-            else
-                cells[r][c]->setText(QString::number(board[r][c]));
-            bool given = cells[r][c]->isReadOnly();
-            cells[r][c]->setStyleSheet(baseCellStyle(r, c, given));
+            cells[r][c]->setText(text);
         }
 }
 
-std::vector<std::vector<int>> MainWindow::loadBoardFromUI() const
+void MainWindow::showMessage(const QString& message)
+{
+    QMessageBox::information(this, "Sudoku", message);
+}
+
+void MainWindow::highlightCell(int row, int col, const QString& color)
+{
+    marks[row][col] = color;
+    restyleCell(row, col);
+}
+
+void MainWindow::clearMarks()
 {
-    std::vector<std::vector<int>> board(9, std::vector<int>(9, 0));
+    conflictUnits = 0;
     for (int r = 0; r < 9; ++r)
         for (int c = 0; c < 9; ++c) {
-            const QString t = cells[r][c]->text().trimmed();
-            board[r][c] = t.isEmpty() ? 0 : t.toInt();
+            marks[r][c].clear();
+            restyleCell(r, c);
         }
-    return board;
 }
 
-void MainWindow::showMessage(const QString& message)
+QString MainWindow::cellStyle(int r, int c) const
 {
-    QMessageBox::information(this, "Sudoku", message);
+    QString s = baseCellStyle(r, c, cells[r][c]->isReadOnly());
+    const QString& color = inUnits(conflictUnits, r, c) ? kConflictColor : marks[r][c];
+    if (!color.isEmpty()) s += QString(" QLineEdit { background-color: %1; }").arg(color);
+    return s;
 }
 
-void MainWindow::highlightCell(int row, int col, const QString& color)
+void MainWindow::restyleCell(int r, int c)
 {
-    QSignalBlocker b1(cells[row][col]);
-    bool given = cells[row][col]->isReadOnly();
-    cells[row][col]->setStyleSheet(
-        baseCellStyle(row, col, given) +
-        QString(" QLineEdit { background-color: %1; }").arg(color)
-    );
+    QString style = cellStyle(r, c);
+    if (style == appliedStyles[r][c]) return;
+    appliedStyles[r][c] = style;
+    QSignalBlocker b1(cells[r][c]);
+    cells[r][c]->setStyleSheet(style);
+}
+
+// Recomputes the conflicting units from the model and restyles the cells of the units
+// whose state flipped.
+void MainWindow::refreshConflicts()
+{
+    uint8_t values[81];
+    for (int i = 0; i < 81; ++i) values[i] = uint8_t(model.at(i / 9, i % 9));
+    const uint32_t bad = duplicateUnits(values);
+    const uint32_t changed = bad ^ conflictUnits;
+    conflictUnits = bad;
+    if (!changed) return;
+    for (int r = 0; r < 9; ++r)
+        for (int c = 0; c < 9; ++c)
+            if (inUnits(changed, r, c)) restyleCell(r, c);
 }
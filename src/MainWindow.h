@@ -6,8 +6,14 @@
 #include <QPushButton>
 #include <QComboBox>
 #include <QLabel>
+#include <QTimer>
 #include <array>
+#include <functional>
+#include <memory>
+#include <thread>
 #include <vector>
+#include "CancelToken.h"
+#include "PuzzleGenerator.h"
 #include "Service.h"
 
 class MainWindow : public QWidget {
@@ -24,8 +30,16 @@ public slots:
     void onCheckClicked();
     void onCellEdited();
     void onDifficultyChanged(int idx);
+    void onSearchProgress(quint64 nodes);
+
+signals:
+    // Search nodes visited so far by the running background job, a few times a second.
+    void searchProgress(quint64 nodes);
 
 private:
+    // Runs on the worker thread; returns the part that must run on the UI thread.
+    using Job = std::function<std::function<void()>(CancelToken&)>;
+
     QGridLayout* gridLayout;
     std::array<std::array<QLineEdit*, 9>, 9> cells;
 
@@ -37,22 +51,47 @@ private:
     QComboBox* difficultyBox;
     QLabel* livesLabel;
     QLabel* difficultyLabel;
+    QLabel* statusLabel;
+    QTimer* progressTimer;
 
+    // Live copy of the grid, updated per edit; the widgets are only written to.
+    SudokuBoard model;
     Service service;
+    SolveTrace trace;  // of the current puzzle, for hints
+    PuzzleGenerator generator;
     int usedHints = 0;
     int lives = 3;
     int currentDifficulty = 2;
     bool editingGuard = false;
 
-    void loadBoardToUI(const std::vector<std::vector<int>>& board);
-    std::vector<std::vector<int>> loadBoardFromUI() const;
+    // At most one background job; starting another cancels it and drops its result.
+    std::thread worker;
+    std::shared_ptr<CancelToken> job;
+    quint64 jobId = 0;
+    QString jobStatus;
+
+    // Per-cell highlight colour (empty for none) and the stylesheet last applied, so
+    // only cells whose look changes are restyled.
+    std::array<std::array<QString, 9>, 9> marks;
+    std::array<std::array<QString, 9>, 9> appliedStyles;
+    // Units (rows 0-8, columns 9-17, boxes 18-26) shown as conflicting since Check.
+    uint32_t conflictUnits = 0;
+
+    void showModel();
     void showMessage(const QString& message);
     void highlightCell(int row, int col, const QString& color);
+    void clearMarks();
+    QString cellStyle(int r, int c) const;
+    void restyleCell(int r, int c);
+    void refreshConflicts();
 
     static QString baseCellStyle(int r, int c, bool isGiven = false);
-    static bool hasDuplicates(const std::array<int, 9>& arr);
 
-    void resetGame(int difficulty);
+    void startJob(const QString& status, Job work);
+    void cancelJob();
+
+    void resetGame(int difficulty, const QString& doneMessage = QString());
+    void startGame(const SudokuBoard& puzzle, SolveTrace puzzleTrace);
     void loseLifeAndMaybeRestart();
     void refreshInfo();
     QString renderLives() const;
@@ -0,0 +1,114 @@
+#include "PuzzleCache.h"
+#include <algorithm>
+
+PuzzleCache::PuzzleCache(size_t capacity) : capacity_(capacity ? capacity : 1)
+{
+    // Room for a few signatures per entry, so repeats are still seen after a pass over
+    // a corpus of the cache's size.
+    size_t slots = 64;
+    while (slots < 4 * capacity_) slots *= 2;
+    seen_.assign(slots, 0);
+}
+
+bool PuzzleCache::admit(const SudokuBoard& puzzle)
+{
+    const uint64_t signature = isomorphismSignature(puzzle) | 1;  // 0 marks a free slot
+    std::lock_guard<std::mutex> lock(m_);
+    uint64_t& slot = seen_[signature & (seen_.size() - 1)];
+    if (slot == signature) return true;
+    slot = signature;
+    ++skipped_;
+    return false;
+}
+
+PuzzleCache::Entry* PuzzleCache::lookup(const CanonicalKey& key)
+{
+    auto it = index_.find(key);
+    if (it == index_.end()) return nullptr;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return &*it->second;
+}
+
+PuzzleCache::Entry& PuzzleCache::upsert(const CanonicalKey& key)
+{
+    if (Entry* e = lookup(key)) return *e;
+    if (lru_.size() >= capacity_) {
+        index_.erase(lru_.back().key);
+        lru_.pop_back();
+        ++evictions_;
+    }
+    lru_.emplace_front();
+    lru_.front().key = key;
+    index_.emplace(key, lru_.begin());
+    return lru_.front();
+}
+
+bool PuzzleCache::findSolution(const CanonicalKey& key, bool& solvable, SudokuBoard& solution)
+{
+    std::lock_guard<std::mutex> lock(m_);
+    const Entry* e = lookup(key);
+    if (!e || e->solution < 0) { ++misses_; return false; }
+    ++hits_;
+    solvable = e->solution == 1;
+    if (solvable) solution = e->board;
+    return true;
+}
+
+void PuzzleCache::storeSolution(const CanonicalKey& key, bool solvable, const SudokuBoard& solution)
+{
+    std::lock_guard<std::mutex> lock(m_);
+    Entry& e = upsert(key);
+    e.solution = solvable ? 1 : 0;
+    if (solvable) e.board = solution;
+}
+
+bool PuzzleCache::findCount(const CanonicalKey& key, int limit, int& count)
+{
+    std::lock_guard<std::mutex> lock(m_);
+    const Entry* e = lookup(key);
+    if (!e || e->count < 0 || (e->count >= e->countLimit && e->countLimit < limit)) { ++misses_; return false; }
+    ++hits_;
+    count = e->count < limit ? e->count : limit;
+    return true;
+}
+
+void PuzzleCache::storeCount(const CanonicalKey& key, int limit, int count)
+{
+    std::lock_guard<std::mutex> lock(m_);
+    Entry& e = upsert(key);
+    const bool exact = e.count >= 0 && e.count < e.countLimit;
+    if (exact || (e.count >= 0 && e.countLimit >= limit && count >= limit)) return;
+    e.count = count;
+    e.countLimit = limit;
+}
+
+bool PuzzleCache::findRating(const CanonicalKey& key, double& rating)
+{
+    std::lock_guard<std::mutex> lock(m_);
+    const Entry* e = lookup(key);
+    if (!e || e->rating < 0) { ++misses_; return false; }
+    ++hits_;
+    rating = e->rating;
+    return true;
+}
+
+void PuzzleCache::storeRating(const CanonicalKey& key, double rating)
+{
+    std::lock_guard<std::mutex> lock(m_);
+    upsert(key).rating = rating;
+}
+
+size_t PuzzleCache::hits() const { std::lock_guard<std::mutex> lock(m_); return hits_; }
+size_t PuzzleCache::misses() const { std::lock_guard<std::mutex> lock(m_); return misses_; }
+size_t PuzzleCache::skipped() const { std::lock_guard<std::mutex> lock(m_); return skipped_; }
+size_t PuzzleCache::evictions() const { std::lock_guard<std::mutex> lock(m_); return evictions_; }
+size_t PuzzleCache::size() const { std::lock_guard<std::mutex> lock(m_); return lru_.size(); }
+
+void PuzzleCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_);
+    lru_.clear();
+    index_.clear();
+    std::fill(seen_.begin(), seen_.end(), 0);
+    hits_ = misses_ = evictions_ = skipped_ = 0;
+}
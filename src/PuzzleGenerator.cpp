@@ -0,0 +1,208 @@
+#include "PuzzleGenerator.h"
+#include <algorithm>
+#include <memory>
+#include "WorkStealingPool.h"
+
+namespace {
+
+struct alignas(64) GenWorker {
+    Service service{ Engine::Candidates };
+};
+
+// Runs make(service, i) for i in 0 .. count - 1 on a pool of `threads` workers, each
+// with its own Service, a chunk of indices per task. A bounded reorder ring hands the
+// finished chunks to sink(i, puzzle) on the calling thread in index order.
+template <typename Make>
+void generateEach(size_t count, unsigned threads, Make make, const std::function<void(size_t, const SudokuBoard&)>& sink)
+{
+    struct Slot {
+        std::vector<SudokuBoard> puzzles;
+        bool ready = false;
+    };
+
+    WorkStealingPool pool(threads);
+    std::vector<std::unique_ptr<GenWorker>> workers;
+    for (unsigned i = 0; i < pool.size(); ++i) workers.push_back(std::make_unique<GenWorker>());
+    // Small runs still spread over every worker; large ones stop at 64 puzzles a task.
+    const size_t chunk = std::min<size_t>(64, std::max<size_t>(1, count / (4 * size_t(pool.size()))));
+    const size_t capacity = size_t(pool.size()) * 4;
+    std::vector<Slot> ring(capacity);
+    std::mutex m;
+    std::condition_variable readyCv;
+    size_t submitted = 0, written = 0;
+
+    auto flushOne = [&] {
+        Slot& slot = ring[written % capacity];
+        {
+            std::unique_lock<std::mutex> lk(m);
+            readyCv.wait(lk, [&] { return slot.ready; });
+        }
+        const size_t first = written * chunk;
+        for (size_t i = 0; i < slot.puzzles.size(); ++i) sink(first + i, slot.puzzles[i]);
+        slot.ready = false;
+        ++written;
+    };
+
+    for (size_t first = 0; first < count; first += chunk) {
+        if (submitted - written == capacity) flushOne();
+        Slot& slot = ring[submitted % capacity];
+        const size_t last = std::min(count, first + chunk);
+        pool.submit([&workers, &make, &slot, &m, &readyCv, first, last](unsigned wi) {
+            slot.puzzles.clear();
+            for (size_t i = first; i < last; ++i) slot.puzzles.push_back(make(workers[wi]->service, i));
+            std::lock_guard<std::mutex> lk(m);
+            slot.ready = true;
+            readyCv.notify_all();
+        });
+        ++submitted;
+    }
+    while (written < submitted) flushOne();
+    pool.wait();
+}
+
+}
+
+PuzzleGenerator::PuzzleGenerator(size_t poolCapacity, unsigned refillThreads)
+    : capacity_(poolCapacity)
+{
+    for (unsigned i = 0; i < refillThreads; ++i) workers_.emplace_back([this] { refillLoop(); });
+}
+
+PuzzleGenerator::~PuzzleGenerator()
+{
+    { std::lock_guard<std::mutex> lk(m_); stop_ = true; }
+    refill_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+int PuzzleGenerator::levelIndex(int difficulty)
+{
+    return difficulty >= 1 && difficulty <= kLevels ? difficulty - 1 : -1;
+}
+
+SudokuBoard PuzzleGenerator::generate(int difficulty)
+{
+    return Service(Engine::Candidates).generateBoard(difficulty);
+}
+
+SudokuBoard PuzzleGenerator::generate(int difficulty, uint64_t seed, uint64_t index)
+{
+    Rng rng(seed, index);
+    return Service(Engine::Candidates).generateBoard(difficulty, rng);
+}
+
+SudokuBoard PuzzleGenerator::generate(const GenerateOptions& opt, uint64_t seed, uint64_t index)
+{
+    Rng rng(seed, index);
+    SudokuBoard b;
+    if (!Service(Engine::Candidates).generateBoard(opt, rng, b)) return SudokuBoard();
+    return b;
+}
+
+SudokuBoard PuzzleGenerator::next(int difficulty)
+{
+    SudokuBoard b;
+    if (tryPop(difficulty, b)) return b;
+    return generate(difficulty);
+}
+
+bool PuzzleGenerator::tryPop(int difficulty, SudokuBoard& out)
+{
+    int level = levelIndex(difficulty);
+    if (level < 0) return false;
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        if (pools_[level].empty()) return false;
+        out = pools_[level].front();
+        pools_[level].pop_front();
+    }
+    refill_.notify_one();
+    return true;
+}
+
+size_t PuzzleGenerator::available(int difficulty) const
+{
+    int level = levelIndex(difficulty);
+    if (level < 0) return 0;
+    std::lock_guard<std::mutex> lk(m_);
+    return pools_[level].size();
+}
+
+// Level with the largest shortfall, counting puzzles already being generated; -1 if full.
+int PuzzleGenerator::neediestLevel() const
+{
+    int best = -1;
+    size_t bestHave = capacity_;
+    for (int level = 0; level < kLevels; ++level) {
+        size_t have = pools_[level].size() + size_t(inProgress_[level]);
+        if (have < bestHave) { best = level; bestHave = have; }
+    }
+    return best;
+}
+
+void PuzzleGenerator::refillLoop()
+{
+    std::unique_lock<std::mutex> lk(m_);
+    for (;;) {
+        refill_.wait(lk, [this] { return stop_ || neediestLevel() >= 0; });
+        if (stop_) return;
+        int level = neediestLevel();
+        ++inProgress_[level];
+        lk.unlock();
+        SudokuBoard b = generate(level + 1);
+        lk.lock();
+        --inProgress_[level];
+        pools_[level].push_back(b);
+    }
+}
+
+std::vector<SudokuBoard> PuzzleGenerator::generateBulk(int difficulty, size_t count, unsigned threads)
+{
+    std::vector<SudokuBoard> out;
+    out.reserve(count);
+    generateStream(difficulty, count, threads, [&out](uint64_t, const SudokuBoard& b) { out.push_back(b); });
+    return out;
+}
+
+std::vector<SudokuBoard> PuzzleGenerator::generateBulk(int difficulty, size_t count, unsigned threads, uint64_t seed,
+    uint64_t first)
+{
+    std::vector<SudokuBoard> out;
+    out.reserve(count);
+    generateStream(difficulty, count, threads, seed, first, [&out](uint64_t, const SudokuBoard& b) { out.push_back(b); });
+    return out;
+}
+
+std::vector<SudokuBoard> PuzzleGenerator::generateBulk(const GenerateOptions& opt, size_t count, unsigned threads,
+    uint64_t seed, uint64_t first)
+{
+    std::vector<SudokuBoard> out;
+    out.reserve(count);
+    generateStream(opt, count, threads, seed, first, [&out](uint64_t, const SudokuBoard& b) { out.push_back(b); });
+    return out;
+}
+
+void PuzzleGenerator::generateStream(int difficulty, size_t count, unsigned threads, const Sink& sink)
+{
+    generateEach(count, threads, [difficulty](Service& s, size_t) { return s.generateBoard(difficulty); },
+        [&sink](size_t i, const SudokuBoard& b) { sink(i, b); });
+}
+
+void PuzzleGenerator::generateStream(int difficulty, size_t count, unsigned threads, uint64_t seed, uint64_t first,
+    const Sink& sink)
+{
+    generateEach(count, threads, [difficulty, seed, first](Service& s, size_t i) {
+        Rng rng(seed, first + i);
+        return s.generateBoard(difficulty, rng);
+    }, [&sink, first](size_t i, const SudokuBoard& b) { sink(first + i, b); });
+}
+
+void PuzzleGenerator::generateStream(const GenerateOptions& opt, size_t count, unsigned threads, uint64_t seed,
+    uint64_t first, const Sink& sink)
+{
+    generateEach(count, threads, [&opt, seed, first](Service& s, size_t i) {
+        Rng rng(seed, first + i);
+        SudokuBoard b;
+        return s.generateBoard(opt, rng, b) ? b : SudokuBoard();
+    }, [&sink, first](size_t i, const SudokuBoard& b) { sink(first + i, b); });
+}
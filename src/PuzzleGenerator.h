@@ -0,0 +1,68 @@
+#pragma once
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Service.h"
+#include "SudokuBoard.h"
+
+// Keeps a bounded pool of ready puzzles for each difficulty (1 = Easy .. 3 = Hard),
+// topped up by background threads, so handing out a puzzle is a pop from a deque.
+// Also offers bulk generation of many puzzles in parallel.
+class PuzzleGenerator {
+public:
+    static constexpr int kLevels = 3;
+    // Receives bulk puzzles on the calling thread in index order.
+    using Sink = std::function<void(uint64_t index, const SudokuBoard& puzzle)>;
+
+    explicit PuzzleGenerator(size_t poolCapacity = 4, unsigned refillThreads = 1);
+    ~PuzzleGenerator();
+
+    PuzzleGenerator(const PuzzleGenerator&) = delete;
+    PuzzleGenerator& operator=(const PuzzleGenerator&) = delete;
+
+    // Pops a pooled puzzle, or generates one on the calling thread if the pool is dry.
+    SudokuBoard next(int difficulty);
+    bool tryPop(int difficulty, SudokuBoard& out);
+    size_t available(int difficulty) const;
+
+    static SudokuBoard generate(int difficulty);
+    static std::vector<SudokuBoard> generateBulk(int difficulty, size_t count, unsigned threads = 0);
+    // Puzzle number `index` of the run seeded with `seed`: generated from its own Rng
+    // stream, so it can be regenerated alone and does not depend on the thread count.
+    static SudokuBoard generate(int difficulty, uint64_t seed, uint64_t index);
+    // Puzzles first .. first + count - 1 of the run seeded with `seed`.
+    static std::vector<SudokuBoard> generateBulk(int difficulty, size_t count, unsigned threads, uint64_t seed,
+        uint64_t first = 0);
+    // Same with symmetry, minimality and rating targets (Service::generateBoard); an
+    // empty board stands for an index where no grid within opt.attempts qualified.
+    static SudokuBoard generate(const GenerateOptions& opt, uint64_t seed, uint64_t index);
+    static std::vector<SudokuBoard> generateBulk(const GenerateOptions& opt, size_t count, unsigned threads,
+        uint64_t seed, uint64_t first = 0);
+
+    // The generateBulk runs, streamed: workers take chunks of indices and `sink` gets
+    // each puzzle as soon as those before it are out, so only a few chunks per worker
+    // are held at a time whatever `count` is. Unseeded runs number from 0.
+    static void generateStream(int difficulty, size_t count, unsigned threads, const Sink& sink);
+    static void generateStream(int difficulty, size_t count, unsigned threads, uint64_t seed, uint64_t first,
+        const Sink& sink);
+    static void generateStream(const GenerateOptions& opt, size_t count, unsigned threads, uint64_t seed,
+        uint64_t first, const Sink& sink);
+
+private:
+    const size_t capacity_;
+    mutable std::mutex m_;
+    std::condition_variable refill_;
+    std::array<std::deque<SudokuBoard>, kLevels> pools_;
+    std::array<int, kLevels> inProgress_{};
+    std::vector<std::thread> workers_;
+    bool stop_ = false;
+
+    static int levelIndex(int difficulty);
+    int neediestLevel() const;
+    void refillLoop();
+};
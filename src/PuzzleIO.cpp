@@ -0,0 +1,59 @@
+#include "PuzzleIO.h"
+
+namespace {
+
+int cellValue(char ch)
+{
+    if (ch >= '1' && ch <= '9') return ch - '0';
+    if (ch >= 'A' && ch <= 'Z') return ch - 'A' + 10;
+    if (ch >= 'a' && ch <= 'z') return ch - 'a' + 10;
+    return -1;
+}
+
+}
+
+template <int BR, int BC>
+bool parsePuzzleLine(std::string_view line, BasicBoard<BR, BC>& out)
+{
+    using Board = BasicBoard<BR, BC>;
+    if (line.size() < size_t(Board::kCells)) return false;
+    Board b;
+    for (int i = 0; i < Board::kCells; ++i) {
+        char ch = line[i];
+        if (ch == '.' || ch == '0') continue;
+        int v = cellValue(ch);
+        if (v < 1 || v > Board::kSize) return false;
+        b.put(i / Board::kSize, i % Board::kSize, v);
+    }
+    out = b;
+    return true;
+}
+
+template <int BR, int BC>
+void formatPuzzleLine(const BasicBoard<BR, BC>& board, char* out)
+{
+    using Board = BasicBoard<BR, BC>;
+    for (int i = 0; i < Board::kCells; ++i) {
+        int v = board.at(i / Board::kSize, i % Board::kSize);
+        out[i] = v == 0 ? '.' : v <= 9 ? char('0' + v) : char('A' + v - 10);
+    }
+}
+
+template <int BR, int BC>
+std::string toPuzzleLine(const BasicBoard<BR, BC>& board)
+{
+    std::string s(BasicBoard<BR, BC>::kCells, '.');
+    formatPuzzleLine(board, s.data());
+    return s;
+}
+
+#define SUDOKU_INSTANTIATE_PUZZLE_IO(BR, BC) \
+    template bool parsePuzzleLine(std::string_view, BasicBoard<BR, BC>&); \
+    template void formatPuzzleLine(const BasicBoard<BR, BC>&, char*); \
+    template std::string toPuzzleLine(const BasicBoard<BR, BC>&);
+
+SUDOKU_INSTANTIATE_PUZZLE_IO(2, 2)
+SUDOKU_INSTANTIATE_PUZZLE_IO(2, 3)
+SUDOKU_INSTANTIATE_PUZZLE_IO(3, 3)
+SUDOKU_INSTANTIATE_PUZZLE_IO(4, 4)
+SUDOKU_INSTANTIATE_PUZZLE_IO(5, 5)
@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include "SudokuBoard.h"
+
+// The common one-puzzle-per-line text form: N*N characters in row-major order, digits
+// 1-9 then letters A-P for values 10-25, and '0' or '.' for empty cells. Anything after
+// the last cell (ratings, comments, a trailing '\r') is ignored. Instantiated in
+// PuzzleIO.cpp for the geometries listed in SudokuBoard.h.
+template <int BR, int BC>
+bool parsePuzzleLine(std::string_view line, BasicBoard<BR, BC>& out);
+template <int BR, int BC>
+void formatPuzzleLine(const BasicBoard<BR, BC>& board, char* out);
+template <int BR, int BC>
+std::string toPuzzleLine(const BasicBoard<BR, BC>& board);
@@ -0,0 +1,168 @@
+#include "RatingPipeline.h"
+#include <algorithm>
+#include <chrono>
+#include "Bits.h"
+#include "SimdKernels.h"
+#include "Strategies.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Mask = CandidateGrid::Mask;
+
+// Upper cost of the strategies each stage adds; the tiers follow difficultyClass().
+constexpr double kSinglesCost = 2.3;
+constexpr double kBasicCost = 3.4;
+
+enum class Closure { Solved, Stuck, Contradiction };
+
+// Places singles in `values` until none is left: hidden singles, plus naked singles
+// when `naked` is set. Every round applies all the singles of one candidate snapshot
+// at once. Singles only ever add placements, so without a contradiction this ends on
+// the same grid as placing them one at a time in the pipeline's order.
+Closure singlesClosure(uint8_t values[81], bool naked, int& placed)
+{
+    const auto& units = CandidateGrid::units();
+    uint16_t cand[81], hidden[27];
+    for (;;) {
+        computeCandidates(values, cand);
+        int before = placed;
+        bool conflict = false;
+        auto put = [&](int cell, int digit) {
+            if (!values[cell]) { values[cell] = uint8_t(digit); ++placed; }
+            else if (values[cell] != digit) conflict = true;
+        };
+        hiddenSingles(cand, hidden);
+        for (int u = 0; u < CandidateGrid::kUnits; ++u)
+            for (Mask m = hidden[u]; m; m &= m - 1) {
+                const int d = lowestBit(m);
+                for (int cell : units[u])
+                    if (cand[cell] & (1u << d)) { put(cell, d + 1); break; }
+            }
+        int open = 0;
+        for (int cell = 0; cell < 81; ++cell) {
+            const Mask m = cand[cell];
+            if (naked && m && !(m & (m - 1))) put(cell, lowestBit(m) + 1);
+            open += values[cell] == 0;
+        }
+        if (conflict) return Closure::Contradiction;
+        if (open == 0) return duplicateUnits(values) ? Closure::Contradiction : Closure::Solved;
+        if (placed == before) return Closure::Stuck;
+    }
+}
+
+}
+
+RatingPipeline::RatingPipeline()
+{
+    const auto& pipeline = defaultStrategies();
+    auto prefix = [&](double maxCost) {
+        size_t n = 0;
+        while (n < pipeline.size() && pipeline[n].cost <= maxCost) ++n;
+        return n;
+    };
+    tierEnd_ = { prefix(kSinglesCost), prefix(kBasicCost), pipeline.size(), 0 };
+}
+
+const char* RatingPipeline::stageName(int stage)
+{
+    switch (stage) {
+    case Singles: return "singles";
+    case BasicTier: return "basic";
+    case AdvancedTier: return "advanced";
+    case Backtracking: return "backtracking";
+    default: return "?";
+    }
+}
+
+void RatingPipeline::rate(const SudokuBoard* boards, size_t n, PuzzleRating* out)
+{
+    auto t0 = Clock::now();
+    pending_.clear();
+    Pending next;
+    for (size_t i = 0; i < n; ++i)
+        if (!singles(boards[i], next, out[i])) {
+            next.index = uint32_t(i);
+            pending_.push_back(next);
+        }
+    auto t1 = Clock::now();
+    counters_[Singles].boards += n;
+    counters_[Singles].settled += n - pending_.size();
+    counters_[Singles].seconds += std::chrono::duration<double>(t1 - t0).count();
+
+    tier(BasicTier, out);
+    tier(AdvancedTier, out);
+
+    // Leftovers: the pipeline got stuck or found a contradiction.
+    t0 = Clock::now();
+    for (const Pending& p : pending_) {
+        const uint8_t count = countLeftovers_ ? uint8_t(solver_.solve(boards[p.index], 2)) : kNotSearched;
+        out[p.index] = { kBeyondPipelineRating, uint8_t(Backtracking), count };
+    }
+    auto& bt = counters_[Backtracking];
+    bt.boards += pending_.size();
+    bt.settled += pending_.size();
+    bt.seconds += std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+// Settles `board` when singles finish it; otherwise loads the grid the later tiers
+// continue from into `p` and returns false.
+bool RatingPipeline::singles(const SudokuBoard& board, Pending& p, PuzzleRating& out) const
+{
+    uint8_t values[81];
+    for (int cell = 0; cell < 81; ++cell) values[cell] = uint8_t(board.at(cell / 9, cell % 9));
+    int placed = 0;
+    Closure c = singlesClosure(values, false, placed);
+    double rating = placed ? findStrategy(Strategy::HiddenSingle)->cost : 0.0;
+    if (c == Closure::Stuck) {
+        c = singlesClosure(values, true, placed);
+        rating = findStrategy(Strategy::NakedSingle)->cost;
+    }
+    if (c == Closure::Solved) {
+        out = { rating, uint8_t(Singles), 1 };
+        return true;
+    }
+
+    // Past the singles every step costs more, so only the candidate state carries over.
+    p.rating = 0;
+    if (c == Closure::Stuck && !duplicateUnits(values)) {
+        SudokuBoard closed = board;
+        for (int cell = 0; cell < 81; ++cell)
+            if (values[cell] && !board.at(cell / 9, cell % 9)) closed.place(cell / 9, cell % 9, values[cell]);
+        p.grid.load(closed);
+        if (!p.grid.broken()) return false;
+    }
+    // A contradiction: the pipeline's own order decides where it shows, so start over.
+    p.grid.load(board);
+    return false;
+}
+
+// Runs the stage's strategy prefix, cheapest first, on every pending board. Finished
+// boards leave; stuck and broken ones stay for the next stage.
+void RatingPipeline::tier(int stage, PuzzleRating* out)
+{
+    const auto t0 = Clock::now();
+    const auto& pipeline = defaultStrategies();
+    const size_t end = tierEnd_[stage];
+    const size_t entered = pending_.size();
+    size_t kept = 0;
+    Step s;
+    for (size_t i = 0; i < entered; ++i) {
+        Pending& p = pending_[i];
+        for (bool progress = !p.grid.broken(); progress;) {
+            progress = false;
+            for (size_t k = 0; k < end; ++k)
+                if (pipeline[k].apply(p.grid, s)) { p.rating = std::max(p.rating, pipeline[k].cost); progress = true; break; }
+        }
+        if (p.grid.unsolved() == 0 && !p.grid.broken()) out[p.index] = { p.rating, uint8_t(stage), 1 };
+        else {
+            if (kept != i) pending_[kept] = p;
+            ++kept;
+        }
+    }
+    pending_.resize(kept);
+    auto& c = counters_[stage];
+    c.boards += entered;
+    c.settled += entered - kept;
+    c.seconds += std::chrono::duration<double>(Clock::now() - t0).count();
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CandidateGrid.h"
+#include "CandidateSolver.h"
+#include "SudokuBoard.h"
+
+// Rating of one board of a RatingPipeline batch.
+struct PuzzleRating {
+    double rating;      // what Service::rateDifficulty() gives with the default strategies
+    uint8_t stage;      // RatingPipeline stage that settled the board
+    uint8_t solutions;  // 1 when the logic finished the board, else 0, 1 or 2 (two or more) from the
+                        // search, or kNotSearched
+};
+
+constexpr uint8_t kNotSearched = 0xff;
+
+struct StageCounters {
+    uint64_t boards = 0;   // boards that entered the stage
+    uint64_t settled = 0;  // boards whose rating the stage decided
+    double seconds = 0;
+    double boardsPerSecond() const { return seconds > 0 ? boards / seconds : 0.0; }
+};
+
+// Rates 9x9 puzzles a batch at a time in stages of rising cost, so a batch dominated by
+// easy puzzles does not pay for the full strategy pipeline on each. The first stage
+// runs hidden and naked singles straight on the vector kernels; the boards it finishes
+// leave the batch. The rest carry their candidate state into the strategy tiers (up to
+// the difficultyClass() 2 bucket, then everything), and only the boards the whole
+// pipeline cannot finish reach the backtracking stage. Ratings equal the one-board path.
+// Keeps its buffers between calls; one pipeline per thread.
+class RatingPipeline {
+public:
+    enum Stage { Singles, BasicTier, AdvancedTier, Backtracking, kStages };
+
+    RatingPipeline();
+
+    void rate(const SudokuBoard* boards, size_t n, PuzzleRating* out);
+
+    // Whether the backtracking stage counts the solutions of the leftovers (default on).
+    // Their rating does not depend on it, and on hard puzzles the search costs more than
+    // all the strategy tiers together.
+    void setCountLeftovers(bool on) { countLeftovers_ = on; }
+
+    const std::array<StageCounters, kStages>& counters() const { return counters_; }
+    void resetCounters() { counters_ = {}; }
+    static const char* stageName(int stage);
+
+private:
+    struct Pending {
+        uint32_t index;
+        double rating;
+        CandidateGrid grid;
+    };
+
+    std::array<StageCounters, kStages> counters_;
+    std::array<size_t, kStages> tierEnd_;  // strategies tried by each tier: a prefix of defaultStrategies()
+    std::vector<Pending> pending_;
+    CandidateSolver solver_;
+    bool countLeftovers_ = true;
+
+    bool singles(const SudokuBoard& board, Pending& p, PuzzleRating& out) const;
+    void tier(int stage, PuzzleRating* out);
+};
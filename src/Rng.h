@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// xoshiro256** seeded through splitmix64: small state, a few cycles per number, and the
+// same sequence on every platform for a given seed. Rng(seed, stream) gives a separate
+// sequence per stream index, so work item i of a parallel run can draw from its own
+// stream and produce the same result whichever thread runs it. Satisfies
+// UniformRandomBitGenerator, but shuffle() and below() should be preferred to the
+// standard distributions and std::shuffle, whose output differs between libraries.
+class Rng {
+public:
+    using result_type = uint64_t;
+
+    explicit Rng(uint64_t seed = 0, uint64_t stream = 0)
+    {
+        // Mixing the stream index in first keeps nearby (seed, stream) pairs unrelated.
+        uint64_t mix = stream + 0x632be59bd9b4e019ull;
+        uint64_t x = seed ^ splitMix(mix);
+        for (auto& word : s_) word = splitMix(x);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, n), n > 0 (Lemire's multiply-and-reject).
+    uint32_t below(uint32_t n)
+    {
+        uint64_t m = uint64_t(uint32_t((*this)() >> 32)) * n;
+        if (uint32_t(m) < n) {
+            const uint32_t threshold = uint32_t(-n) % n;
+            while (uint32_t(m) < threshold) m = uint64_t(uint32_t((*this)() >> 32)) * n;
+        }
+        return uint32_t(m >> 32);
+    }
+
+    // Fisher-Yates over [first, first + n).
+    template <typename T>
+    void shuffle(T* first, size_t n)
+    {
+        for (size_t i = n; i > 1; --i) {
+            const size_t j = below(uint32_t(i));
+            T tmp = first[i - 1];
+            first[i - 1] = first[j];
+            first[j] = tmp;
+        }
+    }
+
+private:
+    uint64_t s_[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    static uint64_t splitMix(uint64_t& x)
+    {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "Strategy.h"
+
+// Instrumentation is compiled in only when SUDOKU_ENABLE_STATS is defined (the CMake
+// option of the same name). Otherwise SUDOKU_STAT(...) expands to nothing and a
+// SearchStats attached to a Service or engine is simply left untouched.
+#if defined(SUDOKU_ENABLE_STATS)
+#define SUDOKU_STATS_ENABLED 1
+#define SUDOKU_STAT(...) __VA_ARGS__
+#else
+#define SUDOKU_STATS_ENABLED 0
+#define SUDOKU_STAT(...) ((void)0)
+#endif
+
+struct StrategyStats {
+    uint64_t attempts = 0;  // full-board scans for this strategy
+    uint64_t hits = 0;      // scans that produced a step
+    double seconds = 0;
+};
+
+// Work counters accumulated by a Service (and the engines it drives) while attached.
+struct SearchStats {
+    uint64_t nodes = 0;       // search nodes visited: digits tried / branch points explored
+    uint64_t backtracks = 0;  // tentative choices undone
+    uint64_t safeChecks = 0;  // SudokuBoard::isSafe calls made by Service
+    int maxDepth = 0;         // deepest stack of tentative choices
+    std::array<StrategyStats, kStrategyCount> strategies{};
+
+    void node(int depth) { ++nodes; if (depth > maxDepth) maxDepth = depth; }
+    void reset() { *this = SearchStats(); }
+};
@@ -1,86 +1,151 @@
 #include "Service.h"
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <random>
+#include <thread>
+#include "CandidateSolver.h"
+#include "Canonical.h"
+#include "DlxSolver.h"
+#include "GridSampler.h"
+#include "UniquenessChecker.h"
 
 Service::Service() : board_() {}
+Service::Service(Engine engine) : board_(), engine_(engine) {}
 
-void Service::loadBoard(const SudokuBoard& b) { board_ = b; }
+// Engines keep their link matrix / search stack per thread and reuse it across calls.
+static int runEngine(Engine engine, const SudokuBoard& board, int limit, SudokuBoard* solution, SearchStats* stats,
+    CancelToken* cancel)
+{
+    int count;
+    if (engine == Engine::DancingLinks) {
+        thread_local DlxSolver dlx;
+        dlx.setStats(stats);
+        dlx.setCancel(cancel);
+        count = dlx.solve(board, limit, solution);
+        dlx.setStats(nullptr);
+        dlx.setCancel(nullptr);
+    }
+    else {
+        thread_local CandidateSolver candidates;
+        candidates.setStats(stats);
+        candidates.setCancel(cancel);
+        count = candidates.solve(board, limit, solution);
+        candidates.setStats(nullptr);
+        candidates.setCancel(nullptr);
+    }
+    return count;
+}
+
+void Service::loadBoard(const SudokuBoard& b) { board_ = b; gridStale_ = true; }
 SudokuBoard Service::getBoard() const { return board_; }
 
-bool Service::solveRecursive(int row, int col)
+bool Service::isSafe(const SudokuBoard& board, int row, int col, int num) const
+{
+    SUDOKU_STAT(if (stats_) ++stats_->safeChecks);
+    return board.isSafe(row, col, num);
+}
+
+bool Service::solveRecursive(int row, int col, int depth)
 {
     if (row == 9) return true;
-    if (col == 9) return solveRecursive(row + 1, 0);
-    if (board_.at(row, col) != 0) return solveRecursive(row, col + 1);
+    if (col == 9) return solveRecursive(row + 1, 0, depth);
+    if (board_.at(row, col) != 0) return solveRecursive(row, col + 1, depth);
 
     for (int num = 1; num <= 9; ++num) {
-        if (board_.isSafe(row, col, num)) {
-            board_.put(row, col, num);
-            if (solveRecursive(row, col + 1)) return true;
-            board_.put(row, col, 0);
+        if (isSafe(board_, row, col, num)) {
+            SUDOKU_STAT(if (stats_) stats_->node(depth));
+            if (cancel_ && cancel_->poll()) return false;
+            board_.place(row, col, num);
+            if (solveRecursive(row, col + 1, depth + 1)) return true;
+            board_.clear(row, col);
+            SUDOKU_STAT(if (stats_) ++stats_->backtracks);
         }
     }
     return false;
 }
 
-bool Service::solve() { return solveRecursive(0, 0); }
+bool Service::solve()
+{
+    gridStale_ = true;
+    if (!cache_ || !cache_->admit(board_)) return solveUncached();
+    const CanonicalForm form = canonicalize(board_);
+    bool solvable;
+    SudokuBoard solution;
+    if (cache_->findSolution(form.key, solvable, solution)) {
+        if (solvable) board_ = form.transform.invert(solution);
+        return solvable;
+    }
+    const bool solved = solveUncached();
+    if (!solved && cancel_ && cancel_->cancelled()) return false;
+    cache_->storeSolution(form.key, solved, solved ? form.transform.apply(board_) : SudokuBoard());
+    return solved;
+}
+
+bool Service::solveUncached()
+{
+    if (engine_ != Engine::Backtracking) {
+        SudokuBoard solved;
+        if (runEngine(engine_, board_, 1, &solved, stats_, cancel_) == 0) return false;
+        board_ = solved;
+        return true;
+    }
+    return solveRecursive(0, 0, 0);
+}
 
 bool Service::isValidMove(int row, int col, int num) const
 {
     if (board_.at(row, col) != 0) return false;
-    return board_.isSafe(row, col, num);
+    return isSafe(board_, row, col, num);
 }
 
 std::tuple<int, int, int> Service::getHint() const
 {
-    for (int r = 0; r < 9; ++r)
-        for (int c = 0; c < 9; ++c)
-            if (board_.at(r, c) == 0) {
-                int cnt = 0, last = 0;
-                for (int n = 1; n <= 9; ++n)
-                    if (board_.isSafe(r, c, n)) { ++cnt; last = n; }
-                if (cnt == 1) return { r,c,last };
-            }
+    Step step;
+    if (getHint(step)) return { step.row, step.col, step.num };
     return { -1,-1,-1 };
 }
 
-bool Service::logicalStep(Step& step)
+bool Service::getHint(Step& step) const
 {
+    if (trace_ && trace_->hint(board_, step)) return true;
     for (int r = 0; r < 9; ++r)
         for (int c = 0; c < 9; ++c)
             if (board_.at(r, c) == 0) {
                 int cnt = 0, last = 0;
                 for (int n = 1; n <= 9; ++n)
-                    if (board_.isSafe(r, c, n)) { ++cnt; last = n; }
-                if (cnt == 1) { board_.put(r, c, last); step = { Strategy::NakedSingle,r,c,last }; return true; }
+                    if (isSafe(board_, r, c, n)) { ++cnt; last = n; }
+                if (cnt == 1) { step = { Strategy::NakedSingle, r, c, last }; return true; }
             }
+    return false;
+}
 
-    for (int n = 1; n <= 9; ++n) {
-        for (int r = 0; r < 9; ++r) {
-            int cnt = 0, lc = -1;
-            for (int c = 0; c < 9; ++c)
-                if (board_.at(r, c) == 0 && board_.isSafe(r, c, n)) { ++cnt; lc = c; }
-            if (cnt == 1) { board_.put(r, lc, n); step = { Strategy::HiddenSingle,r,lc,n }; return true; }
-        }
-        for (int c = 0; c < 9; ++c) {
-            int cnt = 0, lr = -1;
-            for (int r = 0; r < 9; ++r)
-                if (board_.at(r, c) == 0 && board_.isSafe(r, c, n)) { ++cnt; lr = r; }
-            if (cnt == 1) { board_.put(lr, c, n); step = { Strategy::HiddenSingle,lr,c,n }; return true; }
-        }
-        for (int br = 0; br < 3; ++br)
-            for (int bc = 0; bc < 3; ++bc) {
-                int cnt = 0, lr = -1, lc = -1;
-                for (int dr = 0; dr < 3; ++dr)
-                    for (int dc = 0; dc < 3; ++dc) {
-                        int r = br * 3 + dr, c = bc * 3 + dc;
-                        if (board_.at(r, c) == 0 && board_.isSafe(r, c, n)) { ++cnt; lr = r; lc = c; }
-                    }
-                if (cnt == 1) { board_.put(lr, lc, n); step = { Strategy::HiddenSingle,lr,lc,n }; return true; }
-            }
+// Runs one strategy, recording attempts, hits and time when stats are attached.
+bool Service::tryStrategy(const StrategyDef& def, CandidateGrid& grid, Step& step, SearchStats* stats)
+{
+#if SUDOKU_STATS_ENABLED
+    if (stats) {
+        const auto t0 = std::chrono::steady_clock::now();
+        const bool hit = def.apply(grid, step);
+        auto& st = stats->strategies[int(def.id)];
+        ++st.attempts;
+        st.hits += hit;
+        st.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        return hit;
     }
+#endif
+    (void)stats;
+    return def.apply(grid, step);
+}
 
-    if (nakedPairStep(step)) return true;
+bool Service::logicalStep(Step& step)
+{
+    if (gridStale_) { grid_.load(board_); gridStale_ = false; }
+    for (const auto& def : strategies_ ? *strategies_ : defaultStrategies())
+        if (tryStrategy(def, grid_, step, stats_)) {
+            if (step.row >= 0) board_.put(step.row, step.col, step.num);
+            return true;
+        }
 
     step = { Strategy::None,-1,-1,-1 };
     return false;
@@ -93,175 +158,197 @@ bool Service::logicalSolve(std::vector<Step>& steps)
     return progress;
 }
 
-int Service::classifyDifficulty() const
+double Service::rateDifficulty() const
 {
-    Service t = *this;
-    std::vector<Step> steps;
-    int hardest = 0;
-    while (t.logicalSolve(steps)) {
-        for (const auto& s : steps) {
-            if (s.strategy == Strategy::NakedSingle) hardest = std::max(hardest, 1);
-            else if (s.strategy == Strategy::HiddenSingle) hardest = std::max(hardest, 2);
-            else if (s.strategy == Strategy::NakedPair) hardest = std::max(hardest, 3);
-        }
-        steps.clear();
+    if (!cache_ || strategies_) return rateUncached();
+    const CanonicalForm form = canonicalize(board_);
+    double rating;
+    if (cache_->findRating(form.key, rating)) return rating;
+    // Rate the canonical board so every member of the class gets the same answer.
+    Service canonical(engine_);
+    canonical.loadBoard(form.board);
+    rating = canonical.rateUncached();
+    cache_->storeRating(form.key, rating);
+    return rating;
+}
+
+double Service::rateUncached() const
+{
+    const auto& pipeline = strategies_ ? *strategies_ : defaultStrategies();
+    // Steps a scratch copy of the candidates only; board_ and grid_ stay untouched.
+    thread_local CandidateGrid grid;
+    if (gridStale_) grid.load(board_);
+    else grid = grid_;
+    double rating = 0;
+    Step s;
+    for (bool progress = true; progress;) {
+        progress = false;
+        for (const auto& def : pipeline)
+            if (tryStrategy(def, grid, s, stats_)) { rating = std::max(rating, def.cost); progress = true; break; }
     }
-    if (!t.solve()) return 3;
-    if (hardest == 0) return 1;
-    return std::min(hardest, 3);
+    if (grid.unsolved() > 0 || grid.broken()) return kBeyondPipelineRating;
+    return rating;
+}
+
+int difficultyClass(double rating)
+{
+    if (rating <= 2.3) return 1;  // singles only
+    if (rating <= 3.4) return 2;  // locked candidates, pairs, X-Wing
+    return 3;
+}
+
+int Service::classifyDifficulty() const
+{
+    return difficultyClass(rateDifficulty());
 }
 
 int Service::countSolutions(int limit) const
 {
-    int count = 0; solveCount(0, 0, count, limit); return count;
+    CanonicalForm form;
+    int count;
+    const bool cached = cache_ && cache_->admit(board_);
+    if (cached) {
+        form = canonicalize(board_);
+        if (cache_->findCount(form.key, limit, count)) return count;
+    }
+    if (engine_ != Engine::Backtracking) count = runEngine(engine_, board_, limit, nullptr, stats_, cancel_);
+    else {
+        SudokuBoard work = board_;
+        count = 0;
+        solveCount(work, 0, 0, 0, count, limit, stats_, cancel_);
+    }
+    if (cancel_ && cancel_->cancelled()) return count;
+    if (cached) cache_->storeCount(form.key, limit, count);
+    return count;
 }
 
-bool Service::solveCount(int row, int col, int& count, int limit) const
+bool Service::solveCount(SudokuBoard& board, int row, int col, int depth, int& count, int limit, SearchStats* stats,
+    CancelToken* cancel)
 {
     if (count >= limit) return true;
     if (row == 9) { ++count; return count >= limit; }
-    if (col == 9) return solveCount(row + 1, 0, count, limit);
-    if (board_.at(row, col) != 0) return solveCount(row, col + 1, count, limit);
-
-    for (int num = 1; num <= 9; ++num)
-        if (board_.isSafe(row, col, num)) {
-            const_cast<SudokuBoard&>(board_).put(row, col, num);
-            bool stop = solveCount(row, col + 1, count, limit);
-            const_cast<SudokuBoard&>(board_).put(row, col, 0);
+    if (col == 9) return solveCount(board, row + 1, 0, depth, count, limit, stats, cancel);
+    if (board.at(row, col) != 0) return solveCount(board, row, col + 1, depth, count, limit, stats, cancel);
+
+    for (int num = 1; num <= 9; ++num) {
+        SUDOKU_STAT(if (stats) ++stats->safeChecks);
+        if (board.isSafe(row, col, num)) {
+            SUDOKU_STAT(if (stats) stats->node(depth));
+            if (cancel && cancel->poll()) return true;
+            board.place(row, col, num);
+            bool stop = solveCount(board, row, col + 1, depth + 1, count, limit, stats, cancel);
+            board.clear(row, col);
+            SUDOKU_STAT(if (stats) ++stats->backtracks);
             if (stop) return true;
         }
+    }
     return false;
 }
 
 std::vector<std::vector<int>> Service::generatePuzzle(int difficulty) const
 {
-    Service work;
-    SudokuBoard b;
-    std::vector<std::vector<int>> full(9, std::vector<int>(9, 0));
-
-    std::random_device rd; std::mt19937 gen(rd());
-
-    for (int d = 0; d < 9; d += 3) {
-        std::vector<int> nums{ 1,2,3,4,5,6,7,8,9 };
-        std::shuffle(nums.begin(), nums.end(), gen);
-        int k = 0;
-        for (int r = 0; r < 3; ++r)
-            for (int c = 0; c < 3; ++c)
-                full[d + r][d + c] = nums[k++];
-    }
+    return generateBoard(difficulty).getGrid();
+}
 
-    b.setGrid(full); work.loadBoard(b); work.solve(); full = work.getBoard().getGrid();
+SudokuBoard Service::generateBoard(int difficulty) const
+{
+    // Seeded once per thread: a random_device per puzzle can mean a system call.
+    thread_local Rng rng(std::random_device{}(), std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    return generateBoard(difficulty, rng);
+}
 
-    int targetClues;
+GenerateOptions difficultyOptions(int difficulty)
+{
+    GenerateOptions opt;
     switch (difficulty) {
-    case 1: targetClues = 36; break;
-    case 2: targetClues = 30; break;
-    case 3: targetClues = 26; break;
-    default: targetClues = 32; break;
-    }
-    int toRemove = 81 - targetClues;
-
-    std::vector<std::pair<int, int>> idx;
-    idx.reserve(81);
-    for (int r = 0; r < 9; ++r)
-        for (int c = 0; c < 9; ++c)
-            idx.emplace_back(r, c);
-    std::shuffle(idx.begin(), idx.end(), gen);
-
-    auto puzzle = full;
-
-    for (auto [r, c] : idx) {
-        if (toRemove <= 0) break;
-        if (puzzle[r][c] == 0) continue;
-        int saved = puzzle[r][c];
-        puzzle[r][c] = 0;
-        SudokuBoard tb; tb.setGrid(puzzle);
-        Service t; t.loadBoard(tb);
-        if (t.countSolutions(2) == 1) --toRemove;
-        else puzzle[r][c] = saved;
+    case 1: opt.clues = 36; break;
+    case 2: opt.clues = 30; break;
+    case 3: opt.clues = 26; break;
+    default: opt.clues = 32; break;
     }
+    return opt;
+}
 
-    return puzzle;
+SudokuBoard Service::generateBoard(int difficulty, Rng& rng) const
+{
+    // Kept even when uniqueness stops the removal short of the clue target.
+    SudokuBoard b;
+    generateAttempt(difficultyOptions(difficulty), rng, b);
+    return b;
 }
 
-static inline void buildCandidates(const SudokuBoard& b, std::array<std::array<std::vector<int>, 9>, 9>& cand) {
-    for (int r = 0;r < 9;++r)
-        for (int c = 0;c < 9;++c) {
-            cand[r][c].clear();
-            if (b.at(r, c) != 0) continue;
-            for (int n = 1;n <= 9;++n)
-                if (b.isSafe(r, c, n)) cand[r][c].push_back(n);
-        }
+bool Service::generateBoard(const GenerateOptions& opt, Rng& rng, SudokuBoard& out) const
+{
+    for (int attempt = 0; attempt < opt.attempts; ++attempt)
+        if (generateAttempt(opt, rng, out)) return true;
+    return false;
 }
 
-static bool applyNakedPairOnUnit(const SudokuBoard& b,
-    const std::array<std::array<std::vector<int>, 9>, 9>& cand,
-    const std::vector<std::pair<int, int>>& cellsIdx,
-    std::array<std::array<std::vector<int>, 9>, 9>& outCand)
+// Cell that `symmetry` maps `cell` to.
+static int mirrorCell(Symmetry symmetry, int cell)
 {
-    bool changed = false;
-    for (auto [r, c] : cellsIdx) outCand[r][c] = cand[r][c];
-
-    for (size_t i = 0;i < cellsIdx.size();++i) {
-        auto [r1, c1] = cellsIdx[i];
-        if (b.at(r1, c1) != 0 || outCand[r1][c1].size() != 2) continue;
-        for (size_t j = i + 1;j < cellsIdx.size();++j) {
-            auto [r2, c2] = cellsIdx[j];
-            if (b.at(r2, c2) != 0 || outCand[r2][c2].size() != 2) continue;
-            if (outCand[r1][c1] == outCand[r2][c2]) {
-                const auto pairVals = outCand[r1][c1];
-                for (auto [rr, cc] : cellsIdx) {
-                    if ((rr == r1 && cc == c1) || (rr == r2 && cc == c2)) continue;
-                    if (b.at(rr, cc) != 0) continue;
-                    auto& v = outCand[rr][cc];
-                    size_t before = v.size();
-                    v.erase(std::remove_if(v.begin(), v.end(), [&](int x) {
-                        return x == pairVals[0] || x == pairVals[1];
-                        }), v.end());
-                    if (v.size() != before) changed = true;
-                }
-            }
-        }
+    const int r = cell / 9, c = cell % 9;
+    switch (symmetry) {
+    case Symmetry::Rotational180: return 80 - cell;
+    case Symmetry::Rotational90: return c * 9 + (8 - r);
+    case Symmetry::Mirror: return r * 9 + (8 - c);
+    case Symmetry::Diagonal: return c * 9 + r;
+    default: return cell;
     }
-    return changed;
 }
 
-bool Service::nakedPairStep(Step& step)
+bool Service::generateAttempt(const GenerateOptions& opt, Rng& rng, SudokuBoard& out) const
 {
-    std::array<std::array<std::vector<int>, 9>, 9> cand, after;
-    buildCandidates(board_, cand);
-    after = cand;
-
-    bool changed = false;
-
-    for (int r = 0;r < 9;++r) {
-        std::vector<std::pair<int, int>> idx;
-        for (int c = 0;c < 9;++c) idx.emplace_back(r, c);
-        changed |= applyNakedPairOnUnit(board_, cand, idx, after);
-    }
-    for (int c = 0;c < 9;++c) {
-        std::vector<std::pair<int, int>> idx;
-        for (int r = 0;r < 9;++r) idx.emplace_back(r, c);
-        changed |= applyNakedPairOnUnit(board_, cand, idx, after);
+    Service work(engine_);
+    work.setStats(stats_);
+    SudokuBoard grid;
+    (sampler_ ? *sampler_ : GridSampler::shared()).sample(rng, grid);
+
+    // Cells that have to be removed together: the orbits of the symmetry.
+    std::array<std::array<int, 4>, 81> groups;
+    std::array<uint8_t, 81> groupSize{}, seen{};
+    int groupCount = 0;
+    for (int cell = 0; cell < 81; ++cell) {
+        if (seen[cell]) continue;
+        int n = 0;
+        for (int x = cell; !seen[x]; x = mirrorCell(opt.symmetry, x)) {
+            seen[x] = 1;
+            groups[groupCount][n++] = x;
+        }
+        groupSize[groupCount++] = uint8_t(n);
     }
-    for (int br = 0;br < 3;++br) for (int bc = 0;bc < 3;++bc) {
-        std::vector<std::pair<int, int>> idx;
-        for (int dr = 0;dr < 3;++dr) for (int dc = 0;dc < 3;++dc)
-            idx.emplace_back(br * 3 + dr, bc * 3 + dc);
-        changed |= applyNakedPairOnUnit(board_, cand, idx, after);
+    std::array<uint8_t, 81> idx;
+    for (int i = 0; i < groupCount; ++i) idx[i] = uint8_t(i);
+    rng.shuffle(idx.data(), size_t(groupCount));
+
+    // Once rejected, a removal stays rejected as more clues go, so a single pass over
+    // the groups ends with a minimal puzzle (per group) unless it stops early. With a
+    // symmetry the last group removed may take the count up to 3 below the target.
+    const int targetClues = opt.minimal ? 0 : opt.clues;
+    const bool stopAtRating = !opt.minimal && opt.minRating > 0;
+    double rating = -1;
+    thread_local UniquenessChecker checker;
+    checker.reset(grid);
+    checker.setStats(stats_);
+    for (int i = 0; i < groupCount; ++i) {
+        if (checker.clues() <= targetClues) break;
+        const auto& group = groups[idx[i]];
+        const int n = groupSize[idx[i]];
+        if (!(n == 1 ? checker.tryRemove(group[0] / 9, group[0] % 9) : checker.tryRemove(group.data(), n))) continue;
+        if (stopAtRating) {
+            work.loadBoard(checker.puzzle());
+            rating = work.rateDifficulty();
+            if (rating >= opt.minRating) break;
+        }
     }
 
-    if (!changed) return false;
-
-    for (int r = 0;r < 9;++r)
-        for (int c = 0;c < 9;++c)
-            if (board_.at(r, c) == 0 && after[r][c].size() == 1) {
-                int v = after[r][c][0];
-                if (board_.isSafe(r, c, v)) {
-                    board_.put(r, c, v);
-                    step = { Strategy::NakedPair, r, c, v };
-                    return true;
-                }
-            }
-    return false;
+    checker.setStats(nullptr);
+    out = checker.puzzle();
+    if (targetClues > 0 && checker.clues() > targetClues) return false;
+    if (opt.minRating <= 0 && opt.maxRating <= 0) return true;
+    if (rating < 0) {
+        work.loadBoard(out);
+        rating = work.rateDifficulty();
+    }
+    return rating >= opt.minRating && (opt.maxRating <= 0 || rating <= opt.maxRating);
 }
@@ -1,31 +1,123 @@
 #pragma once
 #include <vector>
 #include <tuple>
-#include <random>
+#include "CancelToken.h"
+#include "CandidateGrid.h"
+#include "PuzzleCache.h"
+#include "Rng.h"
+#include "SearchStats.h"
+#include "SolveTrace.h"
 #include "SudokuBoard.h"
-#include "Strategy.h"
+#include "Strategies.h"
 
+class GridSampler;
+
+enum class Engine { Backtracking, DancingLinks, Candidates };
+
+// Symmetry of the clue pattern of generated puzzles: the cells of each orbit are
+// removed together.
+enum class Symmetry { None, Rotational180, Rotational90, Mirror, Diagonal };
+
+struct GenerateOptions {
+    Symmetry symmetry = Symmetry::None;
+    int clues = 0;           // stop once the puzzle is down to this many clues (or just below, by part of an orbit)
+    bool minimal = false;    // remove until no clue (no orbit, with a symmetry) can go; ignores `clues`
+    double minRating = 0;    // accept only rateDifficulty() in [minRating, maxRating]; 0 = unbounded
+    double maxRating = 0;
+    int attempts = 100;      // fresh solution grids tried before giving up
+};
+
+// The clue targets behind generateBoard(difficulty): 36, 30 or 26 clues for 1, 2 or 3.
+GenerateOptions difficultyOptions(int difficulty);
+
+// Coarse 1 (singles), 2 (up to hidden pairs) or 3 bucket of a rating.
+int difficultyClass(double rating);
+
+// Facade over the classic 9x9 game. Hints, strategies, ratings and generation are
+// 9x9 only; other box shapes go through the templated engines directly.
 class Service {
 public:
     Service();
+    explicit Service(Engine engine);
+
+    void setEngine(Engine engine) { engine_ = engine; }
+    Engine engine() const { return engine_; }
+
+    // Counters for subsequent calls are added to `stats` (nullptr detaches). The caller
+    // owns it and must not share one SearchStats between threads.
+    void setStats(SearchStats* stats) { stats_ = stats; }
+
+    // solve, countSolutions and rateDifficulty (default pipeline only) look up and
+    // record their results in `cache` under the board's canonical form (nullptr
+    // detaches). The caller owns it; one cache may be shared between threads.
+    void setCache(PuzzleCache* cache) { cache_ = cache; }
+
+    // solve and countSolutions poll `cancel` once per search node and give up when it
+    // is cancelled or times out: solve returns false, countSolutions the count so far.
+    // Callers tell that apart from a real answer through the token (nullptr detaches).
+    void setCancel(CancelToken* cancel) { cancel_ = cancel; }
 
     void loadBoard(const SudokuBoard& b);
     SudokuBoard getBoard() const;
 
     bool solve();
     bool isValidMove(int row, int col, int num) const;
+    // Next placement: looked up in the attached trace when the board lies on it,
+    // otherwise the first cell with a single safe digit, or {-1,-1,-1}.
     std::tuple<int, int, int> getHint() const;
+    // Same, with the strategy behind it (NakedSingle for the fallback); false for none.
+    bool getHint(Step& step) const;
+    // Trace of the puzzle being played (nullptr detaches); the caller keeps it alive.
+    void setTrace(const SolveTrace* trace) { trace_ = trace; }
+
+    // Strategies tried by logicalStep, cheapest first; nullptr restores
+    // defaultStrategies(). The caller keeps the pipeline alive.
+    void setStrategies(const std::vector<StrategyDef>* pipeline) { strategies_ = pipeline; }
 
+    // Applies the first strategy that makes progress: a placement or eliminations.
     bool logicalStep(Step& step);
     bool logicalSolve(std::vector<Step>& steps);
+    // Cost of the hardest step on the logical solution path (Sudoku Explainer-like
+    // scale, 1.5 to 5.4), or kBeyondPipelineRating when the pipeline gets stuck.
+    double rateDifficulty() const;
+    // difficultyClass(rateDifficulty()).
     int classifyDifficulty() const;
 
     int countSolutions(int limit = 2) const;
     std::vector<std::vector<int>> generatePuzzle(int difficulty = 1) const;
+    // Same puzzle generation without the nested-vector interchange; no heap allocation
+    // once the calling thread has generated one puzzle.
+    SudokuBoard generateBoard(int difficulty = 1) const;
+    // Draws every random choice from `rng`, so the same generator state and difficulty
+    // always give the same puzzle. The solution grid comes from the attached sampler.
+    SudokuBoard generateBoard(int difficulty, Rng& rng) const;
+    // Puzzle meeting `opt`: the clue target is reached (or the puzzle is minimal) and the
+    // rating is in range. Without `minimal`, a minRating stops the removal as soon as it
+    // is reached. False, with the last attempt in `out`, when no grid within
+    // opt.attempts qualifies.
+    bool generateBoard(const GenerateOptions& opt, Rng& rng, SudokuBoard& out) const;
+    // Source of the solution grids behind generated puzzles (nullptr restores
+    // GridSampler::shared()). The caller keeps it alive.
+    void setGridSampler(const GridSampler* sampler) { sampler_ = sampler; }
 
 private:
     SudokuBoard board_;
-    bool solveRecursive(int row, int col);
-    bool solveCount(int row, int col, int& count, int limit) const;
-    bool nakedPairStep(Step& step);
+    Engine engine_ = Engine::Backtracking;
+    SearchStats* stats_ = nullptr;
+    PuzzleCache* cache_ = nullptr;
+    CancelToken* cancel_ = nullptr;
+    const SolveTrace* trace_ = nullptr;
+    // Candidates for the logical strategies; rebuilt from board_ after loadBoard/solve.
+    CandidateGrid grid_;
+    bool gridStale_ = true;
+    const std::vector<StrategyDef>* strategies_ = nullptr;
+    const GridSampler* sampler_ = nullptr;
+    bool isSafe(const SudokuBoard& board, int row, int col, int num) const;
+    bool solveRecursive(int row, int col, int depth);
+    bool solveUncached();
+    double rateUncached() const;
+    static bool solveCount(SudokuBoard& board, int row, int col, int depth, int& count, int limit, SearchStats* stats,
+        CancelToken* cancel);
+    bool generateAttempt(const GenerateOptions& opt, Rng& rng, SudokuBoard& out) const;
+    static bool tryStrategy(const StrategyDef& def, CandidateGrid& grid, Step& step, SearchStats* stats);
 };
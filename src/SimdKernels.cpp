@@ -0,0 +1,371 @@
+#include "SimdKernels.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SUDOKU_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(SUDOKU_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SUDOKU_TARGET_SSE2 __attribute__((target("sse2")))
+#define SUDOKU_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SUDOKU_TARGET_SSE2
+#define SUDOKU_TARGET_AVX2
+#endif
+
+namespace {
+
+constexpr uint16_t kAll = 0x1ff;
+
+// Rows padded to 16 lanes so every row is one aligned AVX2 load (or two SSE2 loads);
+// lanes 9-15 stay zero.
+struct alignas(32) Padded {
+    uint16_t row[9][16];
+};
+
+void loadMasks(const uint16_t masks[81], Padded& p)
+{
+    std::memset(&p, 0, sizeof p);
+    for (int r = 0; r < 9; ++r) std::memcpy(p.row[r], masks + r * 9, 9 * sizeof(uint16_t));
+}
+
+void loadValues(const uint8_t values[81], Padded& p)
+{
+    static constexpr uint16_t kBit[10] = { 0, 1, 2, 4, 8, 16, 32, 64, 128, 256 };
+    std::memset(&p, 0, sizeof p);
+    for (int r = 0; r < 9; ++r)
+        for (int c = 0; c < 9; ++c) p.row[r][c] = kBit[values[r * 9 + c]];
+}
+
+// ---- scalar ----
+
+void unitCountsScalar(const Padded& p, uint16_t once[27], uint16_t many[27])
+{
+    for (int u = 0; u < 27; ++u) once[u] = many[u] = 0;
+    for (int r = 0; r < 9; ++r)
+        for (int c = 0; c < 9; ++c) {
+            const uint16_t m = p.row[r][c];
+            const int units[3] = { r, 9 + c, 18 + (r / 3) * 3 + c / 3 };
+            for (int u : units) {
+                many[u] |= once[u] & m;
+                once[u] |= m;
+            }
+        }
+}
+
+void candidatesScalar(const Padded& p, uint16_t cand[81])
+{
+    uint16_t used[27] = {};
+    for (int r = 0; r < 9; ++r)
+        for (int c = 0; c < 9; ++c) {
+            const uint16_t m = p.row[r][c];
+            used[r] |= m; used[9 + c] |= m; used[18 + (r / 3) * 3 + c / 3] |= m;
+        }
+    for (int r = 0; r < 9; ++r)
+        for (int c = 0; c < 9; ++c)
+            cand[r * 9 + c] = p.row[r][c] ? 0 : uint16_t(kAll & ~(used[r] | used[9 + c] | used[18 + (r / 3) * 3 + c / 3]));
+}
+
+#if defined(SUDOKU_SIMD_X86)
+
+// ---- SSE2: a row is `lo` (lanes 0-7) plus `hi` (lane 8) ----
+
+struct Pair128 { __m128i o, m; };
+
+SUDOKU_TARGET_SSE2 inline Pair128 combine(Pair128 a, Pair128 b)
+{
+    return { _mm_or_si128(a.o, b.o), _mm_or_si128(_mm_or_si128(a.m, b.m), _mm_and_si128(a.o, b.o)) };
+}
+
+// Folds lanes 0-7 of a register into lane 0.
+SUDOKU_TARGET_SSE2 inline Pair128 fold8(Pair128 x)
+{
+    x = combine(x, { _mm_srli_si128(x.o, 8), _mm_srli_si128(x.m, 8) });
+    x = combine(x, { _mm_srli_si128(x.o, 4), _mm_srli_si128(x.m, 4) });
+    return combine(x, { _mm_srli_si128(x.o, 2), _mm_srli_si128(x.m, 2) });
+}
+
+SUDOKU_TARGET_SSE2 inline uint16_t lane0(__m128i v) { return uint16_t(_mm_cvtsi128_si32(v)); }
+
+// Lanes shifted down by `n` across the lo/hi pair.
+template <int n>
+SUDOKU_TARGET_SSE2 inline __m128i shiftPair(__m128i lo, __m128i hi)
+{
+    return _mm_or_si128(_mm_srli_si128(lo, 2 * n), _mm_slli_si128(hi, 16 - 2 * n));
+}
+
+SUDOKU_TARGET_SSE2 void unitCountsSse2(const Padded& p, uint16_t once[27], uint16_t many[27])
+{
+    alignas(16) uint16_t tmp[2][8];
+    const __m128i zero = _mm_setzero_si128();
+    Pair128 colLo{ zero, zero }, colHi{ zero, zero };
+    for (int band = 0; band < 3; ++band) {
+        Pair128 lo{ zero, zero }, hi{ zero, zero };
+        for (int r = band * 3; r < band * 3 + 3; ++r) {
+            const __m128i xl = _mm_load_si128(reinterpret_cast<const __m128i*>(p.row[r]));
+            const __m128i xh = _mm_load_si128(reinterpret_cast<const __m128i*>(p.row[r] + 8));
+            lo = combine(lo, { xl, zero });
+            hi = combine(hi, { xh, zero });
+            const Pair128 row = fold8(combine({ xl, zero }, { xh, zero }));
+            once[r] = lane0(row.o);
+            many[r] = lane0(row.m);
+        }
+        colLo = combine(colLo, lo);
+        colHi = combine(colHi, hi);
+        // Lane 3k of lo now covers columns 3k..3k+2 of the band: box (band, k).
+        Pair128 box = combine(lo, { shiftPair<1>(lo.o, hi.o), shiftPair<1>(lo.m, hi.m) });
+        box = combine(box, { shiftPair<2>(lo.o, hi.o), shiftPair<2>(lo.m, hi.m) });
+        _mm_store_si128(reinterpret_cast<__m128i*>(tmp[0]), box.o);
+        _mm_store_si128(reinterpret_cast<__m128i*>(tmp[1]), box.m);
+        for (int k = 0; k < 3; ++k) {
+            once[18 + band * 3 + k] = tmp[0][3 * k];
+            many[18 + band * 3 + k] = tmp[1][3 * k];
+        }
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(once + 9), colLo.o);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(many + 9), colLo.m);
+    once[17] = lane0(colHi.o);
+    many[17] = lane0(colHi.m);
+}
+
+SUDOKU_TARGET_SSE2 void candidatesSse2(const Padded& p, uint16_t cand[81])
+{
+    alignas(16) uint16_t tmp[8];
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i all = _mm_set1_epi16(short(kAll));
+    __m128i colLo = zero, colHi = zero, boxLo[3], boxHi[3], rowUsed[9];
+    for (int band = 0; band < 3; ++band) {
+        __m128i lo = zero, hi = zero;
+        for (int r = band * 3; r < band * 3 + 3; ++r) {
+            const __m128i xl = _mm_load_si128(reinterpret_cast<const __m128i*>(p.row[r]));
+            const __m128i xh = _mm_load_si128(reinterpret_cast<const __m128i*>(p.row[r] + 8));
+            lo = _mm_or_si128(lo, xl);
+            hi = _mm_or_si128(hi, xh);
+            __m128i x = _mm_or_si128(xl, xh);
+            x = _mm_or_si128(x, _mm_srli_si128(x, 8));
+            x = _mm_or_si128(x, _mm_srli_si128(x, 4));
+            x = _mm_or_si128(x, _mm_srli_si128(x, 2));
+            rowUsed[r] = _mm_set1_epi16(short(lane0(x)));
+        }
+        colLo = _mm_or_si128(colLo, lo);
+        colHi = _mm_or_si128(colHi, hi);
+        const __m128i box = _mm_or_si128(_mm_or_si128(lo, shiftPair<1>(lo, hi)), shiftPair<2>(lo, hi));
+        _mm_store_si128(reinterpret_cast<__m128i*>(tmp), box);
+        boxLo[band] = _mm_setr_epi16(short(tmp[0]), short(tmp[0]), short(tmp[0]), short(tmp[3]),
+            short(tmp[3]), short(tmp[3]), short(tmp[6]), short(tmp[6]));
+        boxHi[band] = _mm_set1_epi16(short(tmp[6]));
+    }
+    alignas(16) uint16_t out[16];
+    for (int r = 0; r < 9; ++r) {
+        const __m128i xl = _mm_load_si128(reinterpret_cast<const __m128i*>(p.row[r]));
+        const __m128i xh = _mm_load_si128(reinterpret_cast<const __m128i*>(p.row[r] + 8));
+        const __m128i usedLo = _mm_or_si128(_mm_or_si128(rowUsed[r], colLo), boxLo[r / 3]);
+        const __m128i usedHi = _mm_or_si128(_mm_or_si128(rowUsed[r], colHi), boxHi[r / 3]);
+        const __m128i cl = _mm_and_si128(_mm_andnot_si128(usedLo, all), _mm_cmpeq_epi16(xl, zero));
+        const __m128i ch = _mm_and_si128(_mm_andnot_si128(usedHi, all), _mm_cmpeq_epi16(xh, zero));
+        _mm_store_si128(reinterpret_cast<__m128i*>(out), cl);
+        _mm_store_si128(reinterpret_cast<__m128i*>(out + 8), ch);
+        std::memcpy(cand + r * 9, out, 9 * sizeof(uint16_t));
+    }
+}
+
+// ---- AVX2: a row is one register ----
+
+struct Pair256 { __m256i o, m; };
+
+SUDOKU_TARGET_AVX2 inline Pair256 combine(Pair256 a, Pair256 b)
+{
+    return { _mm256_or_si256(a.o, b.o), _mm256_or_si256(_mm256_or_si256(a.m, b.m), _mm256_and_si256(a.o, b.o)) };
+}
+
+// Lanes shifted down by `n` across the whole register.
+template <int n>
+SUDOKU_TARGET_AVX2 inline __m256i shiftLanes(__m256i v)
+{
+    return _mm256_alignr_epi8(_mm256_permute2x128_si256(v, v, 0x81), v, 2 * n);
+}
+
+SUDOKU_TARGET_AVX2 void unitCountsAvx2(const Padded& p, uint16_t once[27], uint16_t many[27])
+{
+    alignas(32) uint16_t tmp[2][16];
+    const __m256i zero = _mm256_setzero_si256();
+    Pair256 col{ zero, zero };
+    for (int band = 0; band < 3; ++band) {
+        Pair256 acc{ zero, zero };
+        for (int r = band * 3; r < band * 3 + 3; ++r) {
+            const __m256i x = _mm256_load_si256(reinterpret_cast<const __m256i*>(p.row[r]));
+            acc = combine(acc, { x, zero });
+            // Fold the row into lane 0: high half onto low, then 4, 2, 1 lanes.
+            Pair128 row = combine(Pair128{ _mm256_castsi256_si128(x), _mm_setzero_si128() },
+                Pair128{ _mm256_extracti128_si256(x, 1), _mm_setzero_si128() });
+            row = combine(row, { _mm_srli_si128(row.o, 8), _mm_srli_si128(row.m, 8) });
+            row = combine(row, { _mm_srli_si128(row.o, 4), _mm_srli_si128(row.m, 4) });
+            row = combine(row, { _mm_srli_si128(row.o, 2), _mm_srli_si128(row.m, 2) });
+            once[r] = lane0(row.o);
+            many[r] = lane0(row.m);
+        }
+        col = combine(col, acc);
+        Pair256 box = combine(acc, { shiftLanes<1>(acc.o), shiftLanes<1>(acc.m) });
+        box = combine(box, { shiftLanes<2>(acc.o), shiftLanes<2>(acc.m) });
+        _mm256_store_si256(reinterpret_cast<__m256i*>(tmp[0]), box.o);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(tmp[1]), box.m);
+        for (int k = 0; k < 3; ++k) {
+            once[18 + band * 3 + k] = tmp[0][3 * k];
+            many[18 + band * 3 + k] = tmp[1][3 * k];
+        }
+    }
+    _mm256_store_si256(reinterpret_cast<__m256i*>(tmp[0]), col.o);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(tmp[1]), col.m);
+    std::memcpy(once + 9, tmp[0], 9 * sizeof(uint16_t));
+    std::memcpy(many + 9, tmp[1], 9 * sizeof(uint16_t));
+}
+
+SUDOKU_TARGET_AVX2 void candidatesAvx2(const Padded& p, uint16_t cand[81])
+{
+    alignas(32) uint16_t tmp[16];
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i all = _mm256_set1_epi16(short(kAll));
+    __m256i col = zero, boxUsed[3], rowUsed[9];
+    for (int band = 0; band < 3; ++band) {
+        __m256i acc = zero;
+        for (int r = band * 3; r < band * 3 + 3; ++r) {
+            const __m256i x = _mm256_load_si256(reinterpret_cast<const __m256i*>(p.row[r]));
+            acc = _mm256_or_si256(acc, x);
+            __m128i h = _mm_or_si128(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+            h = _mm_or_si128(h, _mm_srli_si128(h, 8));
+            h = _mm_or_si128(h, _mm_srli_si128(h, 4));
+            h = _mm_or_si128(h, _mm_srli_si128(h, 2));
+            rowUsed[r] = _mm256_set1_epi16(short(lane0(h)));
+        }
+        col = _mm256_or_si256(col, acc);
+        const __m256i box = _mm256_or_si256(_mm256_or_si256(acc, shiftLanes<1>(acc)), shiftLanes<2>(acc));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(tmp), box);
+        const short b0 = short(tmp[0]), b1 = short(tmp[3]), b2 = short(tmp[6]);
+        boxUsed[band] = _mm256_setr_epi16(b0, b0, b0, b1, b1, b1, b2, b2, b2, 0, 0, 0, 0, 0, 0, 0);
+    }
+    for (int r = 0; r < 9; ++r) {
+        const __m256i x = _mm256_load_si256(reinterpret_cast<const __m256i*>(p.row[r]));
+        const __m256i used = _mm256_or_si256(_mm256_or_si256(rowUsed[r], col), boxUsed[r / 3]);
+        const __m256i c = _mm256_and_si256(_mm256_andnot_si256(used, all), _mm256_cmpeq_epi16(x, zero));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(tmp), c);
+        std::memcpy(cand + r * 9, tmp, 9 * sizeof(uint16_t));
+    }
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+bool cpuHasSse2()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return true;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+#endif
+
+SimdLevel supportedLevel()
+{
+#if defined(SUDOKU_SIMD_X86)
+    if (cpuHasAvx2()) return SimdLevel::Avx2;
+    if (cpuHasSse2()) return SimdLevel::Sse2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+struct Kernels {
+    SimdLevel level;
+    void (*unitCounts)(const Padded&, uint16_t*, uint16_t*);
+    void (*candidates)(const Padded&, uint16_t*);
+};
+
+Kernels kernelsFor(SimdLevel level)
+{
+#if defined(SUDOKU_SIMD_X86)
+    if (level == SimdLevel::Avx2) return { level, unitCountsAvx2, candidatesAvx2 };
+    if (level == SimdLevel::Sse2) return { level, unitCountsSse2, candidatesSse2 };
+#endif
+    return { SimdLevel::Scalar, unitCountsScalar, candidatesScalar };
+}
+
+Kernels& active()
+{
+    static Kernels k = kernelsFor(supportedLevel());
+    return k;
+}
+
+}
+
+SimdLevel simdLevel() { return active().level; }
+
+const char* simdLevelName(SimdLevel level)
+{
+    switch (level) {
+    case SimdLevel::Avx2: return "avx2";
+    case SimdLevel::Sse2: return "sse2";
+    default: return "scalar";
+    }
+}
+
+SimdLevel setSimdLevel(SimdLevel level)
+{
+    const SimdLevel best = supportedLevel();
+    active() = kernelsFor(int(level) > int(best) ? best : level);
+    return active().level;
+}
+
+void computeCandidates(const uint8_t values[81], uint16_t cand[81])
+{
+    Padded p;
+    loadValues(values, p);
+    active().candidates(p, cand);
+}
+
+void unitDigitCounts(const uint16_t masks[81], uint16_t once[27], uint16_t many[27])
+{
+    Padded p;
+    loadMasks(masks, p);
+    active().unitCounts(p, once, many);
+}
+
+void hiddenSingles(const uint16_t cand[81], uint16_t hidden[27])
+{
+    uint16_t many[27];
+    unitDigitCounts(cand, hidden, many);
+    for (int u = 0; u < 27; ++u) hidden[u] &= uint16_t(~many[u]);
+}
+
+uint32_t duplicateUnits(const uint8_t values[81])
+{
+    Padded p;
+    uint16_t once[27], many[27];
+    loadValues(values, p);
+    active().unitCounts(p, once, many);
+    uint32_t bad = 0;
+    for (int u = 0; u < 27; ++u)
+        if (many[u]) bad |= 1u << u;
+    return bad;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+
+// Whole-board 9x9 kernels over 16-bit digit masks (digit n = bit n - 1). Each has an
+// AVX2, an SSE2 and a scalar implementation; the widest one the CPU supports is picked
+// on first use. Units are numbered rows 0-8, columns 9-17, boxes 18-26.
+enum class SimdLevel { Scalar, Sse2, Avx2 };
+
+SimdLevel simdLevel();
+const char* simdLevelName(SimdLevel level);
+// Switches to `level`, or the widest supported level below it; returns the one in use.
+SimdLevel setSimdLevel(SimdLevel level);
+
+// Candidate mask of every empty cell of `values` (0 = empty); filled cells get 0.
+void computeCandidates(const uint8_t values[81], uint16_t cand[81]);
+
+// Per unit, the digits present in at least one cell's mask (`once`) and in more than
+// one (`many`).
+void unitDigitCounts(const uint16_t masks[81], uint16_t once[27], uint16_t many[27]);
+
+// Per unit, the digits that have exactly one candidate cell. Digits already placed
+// appear in no candidate mask, so they are never reported.
+void hiddenSingles(const uint16_t cand[81], uint16_t hidden[27]);
+
+// Bit u set for every unit of `values` that holds some digit twice.
+uint32_t duplicateUnits(const uint8_t values[81]);
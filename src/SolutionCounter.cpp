@@ -0,0 +1,77 @@
+#include "SolutionCounter.h"
+#include <atomic>
+#include <climits>
+
+template <int BR, int BC>
+BasicSolutionCounter<BR, BC>::BasicSolutionCounter(unsigned threads) : pool_(threads)
+{
+    for (unsigned i = 0; i < pool_.size(); ++i) workers_.push_back(std::make_unique<Worker>());
+}
+
+template <int BR, int BC>
+uint64_t BasicSolutionCounter<BR, BC>::run(const Board& board, uint64_t limit, const Visitor* visit)
+{
+    boards_.clear();
+    if (splitDepth_ > 0) {
+        if (!splitter_.split(board, splitDepth_, boards_)) return 0;
+    }
+    else {
+        // Splits are cheap next to the count, so deepen from scratch until there is
+        // enough work to balance.
+        const size_t target = kSubproblemsPerThread * pool_.size();
+        for (int depth = 1; depth <= kMaxSplitDepth && boards_.size() < target; ++depth) {
+            boards_.clear();
+            if (!splitter_.split(board, depth, boards_)) return 0;
+        }
+    }
+
+    // Stops the workers once the limit is reached or the visitor says so; linked to the
+    // caller's token so cancel() and its timeout reach every search.
+    CancelToken root;
+    if (cancel_) root.linkTo(*cancel_);
+    std::atomic<uint64_t> total{ 0 }, visited{ 0 };
+    Visitor limited;
+    if (visit) {
+        limited = [&](const Board& solution) {
+            if ((limit && visited.fetch_add(1, std::memory_order_relaxed) >= limit) || !(*visit)(solution)) {
+                root.cancel();
+                return false;
+            }
+            return true;
+        };
+    }
+    for (auto& w : workers_) {
+        w->token = std::make_unique<CancelToken>();
+        w->token->linkTo(root);
+        w->found = 0;
+        w->solver.setCancel(w->token.get());
+        w->solver.setVisitor(visit ? &limited : nullptr);
+    }
+
+    const int cap = limit && limit < uint64_t(INT_MAX) ? int(limit) : INT_MAX;
+    for (const Board& sub : boards_) {
+        pool_.submit([this, &sub, &root, &total, cap, limit](unsigned wi) {
+            if (root.cancelled()) return;
+            Worker& w = *workers_[wi];
+            const uint64_t n = uint64_t(w.solver.solve(sub, cap));
+            w.found += n;
+            if (limit && total.fetch_add(n, std::memory_order_relaxed) + n >= limit) root.cancel();
+        });
+    }
+    pool_.wait();
+
+    uint64_t sum = 0;
+    for (auto& w : workers_) {
+        sum += w->found;
+        w->solver.setCancel(nullptr);
+        w->solver.setVisitor(nullptr);
+        w->token.reset();
+    }
+    return limit && sum > limit ? limit : sum;
+}
+
+template class BasicSolutionCounter<2, 2>;
+template class BasicSolutionCounter<2, 3>;
+template class BasicSolutionCounter<3, 3>;
+template class BasicSolutionCounter<4, 4>;
+template class BasicSolutionCounter<5, 5>;
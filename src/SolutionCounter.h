@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "CancelToken.h"
+#include "CandidateSolver.h"
+#include "SudokuBoard.h"
+#include "WorkStealingPool.h"
+
+// Counts or enumerates every solution of a puzzle on several threads. The search tree
+// is expanded a few branching levels on the calling thread (CandidateSolver::split),
+// and the boards at that depth, whose solution sets do not overlap, are solved as
+// independent tasks on a work-stealing pool. Each worker sums into its own counter;
+// the counters are added up once the pool is idle. Service::countSolutions remains the
+// way to ask small questions such as "unique or not".
+template <int BoxRows, int BoxCols>
+class BasicSolutionCounter {
+public:
+    using Board = BasicBoard<BoxRows, BoxCols>;
+    using Visitor = typename BasicCandidateSolver<BoxRows, BoxCols>::Visitor;
+
+    // Subproblems per thread the automatic split depth aims for.
+    static constexpr size_t kSubproblemsPerThread = 16;
+    static constexpr int kMaxSplitDepth = 24;
+
+    explicit BasicSolutionCounter(unsigned threads = 0);
+
+    unsigned threads() const { return pool_.size(); }
+
+    // Branching levels expanded before the subproblems are handed out; 0 (the default)
+    // picks the shallowest depth giving kSubproblemsPerThread subproblems per thread.
+    void setSplitDepth(int depth) { splitDepth_ = depth; }
+    // Every search polls `cancel` (cancel() from any thread, or its timeout) and the
+    // call returns the solutions found so far (nullptr detaches).
+    void setCancel(CancelToken* cancel) { cancel_ = cancel; }
+
+    // Solutions of `board`, stopping at `limit` (0 = all of them); 0 when the givens
+    // conflict. Same limit semantics as Service::countSolutions. A single subproblem
+    // counts at most INT_MAX solutions.
+    uint64_t count(const Board& board, uint64_t limit = 0) { return run(board, limit, nullptr); }
+    // Same, and passes each solution to `visit`, which is called from the worker threads
+    // concurrently, in no particular order, and must be thread safe. At most `limit`
+    // solutions are visited; returning false stops the enumeration.
+    uint64_t enumerate(const Board& board, const Visitor& visit, uint64_t limit = 0) { return run(board, limit, &visit); }
+
+    // Subproblems the last call was split into.
+    size_t subproblems() const { return boards_.size(); }
+
+private:
+    struct alignas(64) Worker {
+        BasicCandidateSolver<BoxRows, BoxCols> solver;
+        std::unique_ptr<CancelToken> token;
+        uint64_t found = 0;
+    };
+
+    WorkStealingPool pool_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    BasicCandidateSolver<BoxRows, BoxCols> splitter_;
+    std::vector<Board> boards_;
+    CancelToken* cancel_ = nullptr;
+    int splitDepth_ = 0;
+
+    uint64_t run(const Board& board, uint64_t limit, const Visitor* visit);
+};
+
+extern template class BasicSolutionCounter<2, 2>;
+extern template class BasicSolutionCounter<2, 3>;
+extern template class BasicSolutionCounter<3, 3>;
+extern template class BasicSolutionCounter<4, 4>;
+extern template class BasicSolutionCounter<5, 5>;
+
+using SolutionCounter = BasicSolutionCounter<3, 3>;
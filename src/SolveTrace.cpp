@@ -0,0 +1,163 @@
+#include "SolveTrace.h"
+#include "BinaryCorpus.h"
+#include "Bits.h"
+
+namespace {
+
+constexpr char kMagic[4] = { 'S', 'D', 'K', 'T' };
+constexpr uint8_t kVersion = 1;
+constexpr uint8_t kNoCell = 0xff;
+constexpr size_t kPackedCandidateBytes = (81 * 9 + 7) / 8;
+
+}
+
+SolveTrace SolveTrace::record(const SudokuBoard& puzzle, const std::vector<StrategyDef>* pipeline)
+{
+    SolveTrace t;
+    t.puzzle_ = puzzle;
+    CandidateGrid grid;
+    grid.load(puzzle);
+    Candidates snap;
+    for (int i = 0; i < 81; ++i) snap[i] = grid.candidates(i);
+    t.snapshots_.push_back(snap);
+    Step step;
+    for (bool progress = true; progress;) {
+        progress = false;
+        for (const auto& def : pipeline ? *pipeline : defaultStrategies())
+            if (def.apply(grid, step)) { progress = true; break; }
+        if (!progress) break;
+        t.steps_.push_back(step);
+        for (int i = 0; i < 81; ++i) snap[i] = grid.candidates(i);
+        t.snapshots_.push_back(snap);
+    }
+    t.index();
+    return t;
+}
+
+void SolveTrace::index()
+{
+    order_.fill(kNotPlaced);
+    unsolvedAtStart_ = 0;
+    for (int i = 0; i < 81; ++i) {
+        value_[i] = uint8_t(puzzle_.at(i / 9, i % 9));
+        if (!value_[i]) ++unsolvedAtStart_;
+    }
+    placementStep_.clear();
+    for (size_t i = 0; i < steps_.size(); ++i) {
+        const Step& s = steps_[i];
+        if (s.row < 0) continue;
+        const int cell = s.row * 9 + s.col;
+        order_[cell] = uint8_t(placementStep_.size());
+        value_[cell] = uint8_t(s.num);
+        placementStep_.push_back(uint16_t(i));
+    }
+}
+
+SolveTrace::Candidates SolveTrace::removedBy(size_t i) const
+{
+    Candidates out;
+    for (int c = 0; c < 81; ++c) out[c] = CandidateGrid::Mask(snapshots_[i][c] & ~snapshots_[i + 1][c]);
+    return out;
+}
+
+bool SolveTrace::explain(const SudokuBoard& board, size_t& first, size_t& last) const
+{
+    int filled = 0;
+    for (int i = 0; i < 81; ++i) filled += board.at(i / 9, i % 9) != 0;
+    const int k = filled - (81 - unsolvedAtStart_);
+    if (k < 0 || size_t(k) >= placementStep_.size()) return false;
+    // On the trace: the givens and the first k placements, nothing else.
+    for (int i = 0; i < 81; ++i) {
+        const int v = board.at(i / 9, i % 9);
+        const bool expected = puzzle_.at(i / 9, i % 9) != 0 || order_[i] < k;
+        if (expected ? v != value_[i] : v != 0) return false;
+    }
+    first = k == 0 ? 0 : placementStep_[k - 1] + 1;
+    last = placementStep_[k];
+    return true;
+}
+
+bool SolveTrace::hint(const SudokuBoard& board, Step& step) const
+{
+    size_t first, last;
+    if (!explain(board, first, last)) return false;
+    step = steps_[last];
+    return true;
+}
+
+std::string SolveTrace::serialize() const
+{
+    std::string out(kMagic, 4);
+    out += char(kVersion);
+    out += char(steps_.size() & 0xff);
+    out += char(steps_.size() >> 8);
+    uint8_t packed[kPackedGridBytes];
+    packGrid(puzzle_, packed);
+    out.append(reinterpret_cast<const char*>(packed), kPackedGridBytes);
+    std::string bits(kPackedCandidateBytes, '\0');
+    for (int i = 0; i < 81; ++i)
+        for (int b = 0; b < 9; ++b)
+            if (snapshots_[0][i] >> b & 1) bits[(i * 9 + b) >> 3] |= char(1 << ((i * 9 + b) & 7));
+    out += bits;
+    for (size_t i = 0; i < steps_.size(); ++i) {
+        const Step& s = steps_[i];
+        out += char(s.strategy);
+        out += char(s.row < 0 ? kNoCell : s.row * 9 + s.col);
+        out += char(s.row < 0 ? 0 : s.num);
+        const Candidates removed = removedBy(i);
+        uint8_t changed = 0;
+        for (auto m : removed) changed += m != 0;
+        out += char(changed);
+        for (int c = 0; c < 81; ++c)
+            if (removed[c]) {
+                out += char(c);
+                out += char(removed[c] & 0xff);
+                out += char(removed[c] >> 8);
+            }
+    }
+    return out;
+}
+
+bool SolveTrace::deserialize(std::string_view bytes, SolveTrace& out)
+{
+    const auto* p = reinterpret_cast<const uint8_t*>(bytes.data());
+    const auto* end = p + bytes.size();
+    if (bytes.size() < 7 + kPackedGridBytes + kPackedCandidateBytes || bytes.compare(0, 4, kMagic, 4) != 0 || p[4] != kVersion)
+        return false;
+    SolveTrace t;
+    const size_t count = size_t(p[5]) | size_t(p[6]) << 8;
+    p += 7;
+    t.puzzle_ = PackedGrid(p).board();
+    p += kPackedGridBytes;
+    Candidates snap{};
+    for (int i = 0; i < 81; ++i)
+        for (int b = 0; b < 9; ++b)
+            if (p[(i * 9 + b) >> 3] >> ((i * 9 + b) & 7) & 1) snap[i] |= CandidateGrid::Mask(1u << b);
+    p += kPackedCandidateBytes;
+    t.snapshots_.push_back(snap);
+    for (size_t i = 0; i < count; ++i) {
+        if (end - p < 4 || p[0] >= uint8_t(Strategy::None)) return false;
+        Step s{ Strategy(p[0]), -1, -1, 0 };
+        if (p[1] != kNoCell) {
+            if (p[1] >= 81 || p[2] < 1 || p[2] > 9) return false;
+            s.row = p[1] / 9;
+            s.col = p[1] % 9;
+            s.num = p[2];
+        }
+        const int changed = p[3];
+        p += 4;
+        if (end - p < 3 * changed) return false;
+        for (int j = 0; j < changed; ++j, p += 3) {
+            if (p[0] >= 81) return false;
+            const auto removed = CandidateGrid::Mask(p[1] | p[2] << 8);
+            snap[p[0]] &= CandidateGrid::Mask(~removed);
+            if (s.row < 0) s.eliminated += popCount(removed);
+        }
+        t.steps_.push_back(s);
+        t.snapshots_.push_back(snap);
+    }
+    if (p != end) return false;
+    t.index();
+    out = std::move(t);
+    return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "CandidateGrid.h"
+#include "Strategies.h"
+
+// The logical solution path of one 9x9 puzzle, recorded once and then queried: the
+// steps in order, the candidate grid before each of them, and for every board state on
+// the path (the puzzle plus its first k placements) the steps leading to the next
+// placement. Lookups take one pass over the 81 cells whatever the trace length. A
+// recorded trace is never modified, so one copy can answer any number of threads.
+class SolveTrace {
+public:
+    using Candidates = std::array<CandidateGrid::Mask, 81>;
+
+    // Applies `pipeline` (defaultStrategies() when null) until it solves the puzzle or
+    // gets stuck, exactly as Service::logicalSolve would.
+    static SolveTrace record(const SudokuBoard& puzzle, const std::vector<StrategyDef>* pipeline = nullptr);
+
+    const SudokuBoard& puzzle() const { return puzzle_; }
+    size_t size() const { return steps_.size(); }
+    const Step& step(size_t i) const { return steps_[i]; }
+    // Candidates before step i (0 for filled cells); candidatesBefore(size()) is the
+    // state the trace ends in.
+    const Candidates& candidatesBefore(size_t i) const { return snapshots_[i]; }
+    // Candidates step i removed, per cell. For a placement this includes the placed
+    // cell's other candidates and the digit taken from its peers.
+    Candidates removedBy(size_t i) const;
+    // The pipeline filled the whole grid.
+    bool complete() const { return placementStep_.size() == size_t(unsolvedAtStart_); }
+
+    // When `board` is on the trace and a placement is still ahead, steps first..last
+    // lead from it to that placement (last is the placement itself).
+    bool explain(const SudokuBoard& board, size_t& first, size_t& last) const;
+    // The next placement from `board`; false when the board is off the trace or the
+    // trace has no placement left.
+    bool hint(const SudokuBoard& board, Step& step) const;
+
+    // Compact binary form: header, packed puzzle, initial candidates at 9 bits per cell,
+    // then each step with only the (cell, removed mask) pairs it changed.
+    std::string serialize() const;
+    static bool deserialize(std::string_view bytes, SolveTrace& out);
+
+private:
+    static constexpr uint8_t kNotPlaced = 0xff;
+
+    SudokuBoard puzzle_;
+    std::vector<Step> steps_;
+    std::vector<Candidates> snapshots_;    // size() + 1 entries
+    std::vector<uint16_t> placementStep_;  // step index of the k-th placement
+    std::array<uint8_t, 81> order_{};      // k for the cell placed k-th, else kNotPlaced
+    std::array<uint8_t, 81> value_{};      // givens and placed digits
+    int unsolvedAtStart_ = 0;
+
+    void index();
+};
@@ -0,0 +1,326 @@
+#include "Strategies.h"
+#include "Bits.h"
+
+namespace {
+
+using Mask = CandidateGrid::Mask;
+constexpr Mask kAllDigits = SudokuBoard::kAllDigits;
+
+// Removes `digits` from `cell` and returns how many candidates went.
+int removeFrom(CandidateGrid& g, int cell, Mask digits)
+{
+    const int n = popCount(g.candidates(cell) & digits);
+    if (n) g.eliminate(cell, digits);
+    return n;
+}
+
+bool eliminationStep(Strategy id, int removed, Step& step)
+{
+    if (removed == 0) return false;
+    step = { id, -1, -1, 0, removed };
+    return true;
+}
+
+// Calls f(idx) with every ascending k-subset of 0..n-1 (k <= 4) until f returns true.
+template <class F>
+bool forEachSubset(int n, int k, F&& f)
+{
+    if (k > n) return false;
+    int idx[4];
+    for (int i = 0; i < k; ++i) idx[i] = i;
+    for (;;) {
+        if (f(idx)) return true;
+        int i = k - 1;
+        while (i >= 0 && idx[i] == n - k + i) --i;
+        if (i < 0) return false;
+        ++idx[i];
+        for (int j = i + 1; j < k; ++j) idx[j] = idx[j - 1] + 1;
+    }
+}
+
+bool nakedSingle(CandidateGrid& g, Step& step)
+{
+    int cell, digit;
+    if (!g.nextNakedSingle(cell, digit)) return false;
+    g.place(cell, digit);
+    step = { Strategy::NakedSingle, cell / 9, cell % 9, digit };
+    return true;
+}
+
+bool hiddenSingle(CandidateGrid& g, Step& step)
+{
+    int cell, digit;
+    if (!g.nextHiddenSingle(cell, digit)) return false;
+    g.place(cell, digit);
+    step = { Strategy::HiddenSingle, cell / 9, cell % 9, digit };
+    return true;
+}
+
+// A digit confined to one row or column of a box leaves the rest of that line.
+bool pointingPair(CandidateGrid& g, Step& step)
+{
+    static constexpr uint16_t kBoxRow[3] = { 0x007, 0x038, 0x1c0 }, kBoxCol[3] = { 0x049, 0x092, 0x124 };
+    for (int b = 0; b < 9; ++b)
+        for (int d = 1; d <= 9; ++d) {
+            const uint16_t w = g.places(18 + b, d);
+            if (popCount(w) < 2) continue;
+            int removed = 0;
+            for (int k = 0; k < 3; ++k) {
+                if (!(w & ~kBoxRow[k])) {
+                    const int r = (b / 3) * 3 + k;
+                    for (int c = 0; c < 9; ++c)
+                        if (c / 3 != b % 3) removed += removeFrom(g, r * 9 + c, SudokuBoard::bit(d));
+                }
+                if (!(w & ~kBoxCol[k])) {
+                    const int c = (b % 3) * 3 + k;
+                    for (int r = 0; r < 9; ++r)
+                        if (r / 3 != b / 3) removed += removeFrom(g, r * 9 + c, SudokuBoard::bit(d));
+                }
+            }
+            if (eliminationStep(Strategy::PointingPair, removed, step)) return true;
+        }
+    return false;
+}
+
+// A digit confined to one box within a row or column leaves the rest of that box.
+bool boxLineReduction(CandidateGrid& g, Step& step)
+{
+    static constexpr uint16_t kThird[3] = { 0x007, 0x038, 0x1c0 };
+    const auto& units = CandidateGrid::units();
+    for (int u = 0; u < 18; ++u)
+        for (int d = 1; d <= 9; ++d) {
+            const uint16_t w = g.places(u, d);
+            if (popCount(w) < 2) continue;
+            for (int k = 0; k < 3; ++k) {
+                if (w & ~kThird[k]) continue;
+                const bool row = u < 9;
+                const int line = row ? u : u - 9;
+                const int box = row ? (line / 3) * 3 + k : k * 3 + line / 3;
+                int removed = 0;
+                for (int cell : units[18 + box])
+                    if ((row ? cell / 9 : cell % 9) != line) removed += removeFrom(g, cell, SudokuBoard::bit(d));
+                if (eliminationStep(Strategy::BoxLineReduction, removed, step)) return true;
+            }
+        }
+    return false;
+}
+
+// k cells of a unit whose candidates together are k digits own those digits.
+bool nakedSubset(CandidateGrid& g, int k, Strategy id, Step& step)
+{
+    for (const auto& unit : CandidateGrid::units()) {
+        int cells[9], n = 0, open = 0;
+        for (int cell : unit) {
+            const int p = popCount(g.candidates(cell));
+            if (p) ++open;
+            if (p >= 2 && p <= k) cells[n++] = cell;
+        }
+        if (open <= k) continue;
+        int removed = 0;
+        forEachSubset(n, k, [&](const int* idx) {
+            Mask m = 0;
+            for (int i = 0; i < k; ++i) m |= g.candidates(cells[idx[i]]);
+            if (popCount(m) != k) return false;
+            for (int cell : unit) {
+                bool member = false;
+                for (int i = 0; i < k; ++i) member |= cells[idx[i]] == cell;
+                if (!member) removed += removeFrom(g, cell, m);
+            }
+            return removed > 0;
+        });
+        if (eliminationStep(id, removed, step)) return true;
+    }
+    return false;
+}
+
+// k digits of a unit confined to the same k cells push out every other candidate there.
+bool hiddenSubset(CandidateGrid& g, int k, Strategy id, Step& step)
+{
+    const auto& units = CandidateGrid::units();
+    for (int u = 0; u < CandidateGrid::kUnits; ++u) {
+        int digits[9], n = 0, open = 0;
+        for (int d = 1; d <= 9; ++d) {
+            const int p = popCount(g.places(u, d));
+            if (p) ++open;
+            if (p >= 2 && p <= k) digits[n++] = d;
+        }
+        if (open <= k) continue;
+        int removed = 0;
+        forEachSubset(n, k, [&](const int* idx) {
+            uint16_t where = 0;
+            Mask keep = 0;
+            for (int i = 0; i < k; ++i) {
+                where |= g.places(u, digits[idx[i]]);
+                keep |= SudokuBoard::bit(digits[idx[i]]);
+            }
+            if (popCount(where) != k) return false;
+            for (; where; where &= where - 1)
+                removed += removeFrom(g, units[u][lowestBit(where)], Mask(kAllDigits & ~keep));
+            return removed > 0;
+        });
+        if (eliminationStep(id, removed, step)) return true;
+    }
+    return false;
+}
+
+// X-Wing (k = 2) and Swordfish (k = 3): k rows whose places for a digit lie in the
+// same k columns clear it from the rest of those columns, and vice versa.
+bool fish(CandidateGrid& g, int k, Strategy id, Step& step)
+{
+    const auto& units = CandidateGrid::units();
+    for (int d = 1; d <= 9; ++d)
+        for (int base = 0; base < 18; base += 9) {
+            int lines[9], n = 0;
+            for (int i = 0; i < 9; ++i) {
+                const int p = popCount(g.places(base + i, d));
+                if (p >= 2 && p <= k) lines[n++] = i;
+            }
+            int removed = 0;
+            forEachSubset(n, k, [&](const int* idx) {
+                uint16_t cover = 0, baseSet = 0;
+                for (int i = 0; i < k; ++i) {
+                    cover |= g.places(base + lines[idx[i]], d);
+                    baseSet |= uint16_t(1u << lines[idx[i]]);
+                }
+                if (popCount(cover) != k) return false;
+                // Position i of a cover line lies on base line i.
+                for (; cover; cover &= cover - 1) {
+                    const auto& unit = units[(9 - base) + lowestBit(cover)];
+                    for (int i = 0; i < 9; ++i)
+                        if (!(baseSet & (1u << i))) removed += removeFrom(g, unit[i], SudokuBoard::bit(d));
+                }
+                return removed > 0;
+            });
+            if (eliminationStep(id, removed, step)) return true;
+        }
+    return false;
+}
+
+// Pivot {x,y} seeing pincers {x,z} and {y,z}: z goes from every cell seeing both pincers.
+bool xyWing(CandidateGrid& g, Step& step)
+{
+    const auto& peers = CandidateGrid::peers();
+    for (int pivot = 0; pivot < 81; ++pivot) {
+        const Mask pm = g.candidates(pivot);
+        if (popCount(pm) != 2) continue;
+        for (int a : peers[pivot]) {
+            const Mask am = g.candidates(a);
+            if (popCount(am) != 2 || popCount(am & pm) != 1) continue;
+            const Mask z = Mask(am & ~pm);
+            const Mask bm = Mask((pm & ~am) | z);
+            for (int b : peers[pivot]) {
+                if (b == a || g.candidates(b) != bm) continue;
+                int removed = 0;
+                for (int cell = 0; cell < 81; ++cell)
+                    if (cell != pivot && CandidateGrid::sees(cell, a) && CandidateGrid::sees(cell, b))
+                        removed += removeFrom(g, cell, z);
+                if (eliminationStep(Strategy::XYWing, removed, step)) return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Two-colours chains of conjugate pairs (units with exactly two places for a digit).
+// Two cells of one colour seeing each other make that colour false; a cell seeing
+// both colours cannot hold the digit.
+bool simpleColoring(CandidateGrid& g, Step& step)
+{
+    const auto& units = CandidateGrid::units();
+    for (int d = 1; d <= 9; ++d) {
+        const Mask bit = SudokuBoard::bit(d);
+        std::array<std::array<uint8_t, 3>, 81> link;
+        std::array<uint8_t, 81> links{};
+        for (int u = 0; u < CandidateGrid::kUnits; ++u) {
+            const uint16_t w = g.places(u, d);
+            if (popCount(w) != 2) continue;
+            const int a = units[u][lowestBit(w)], b = units[u][lowestBit(w & (w - 1))];
+            link[a][links[a]++] = uint8_t(b);
+            link[b][links[b]++] = uint8_t(a);
+        }
+        std::array<int8_t, 81> color;
+        color.fill(-1);
+        for (int start = 0; start < 81; ++start) {
+            if (!links[start] || color[start] >= 0) continue;
+            int chain[81], n = 0;
+            std::array<bool, 81> inChain{};
+            color[start] = 0;
+            chain[n++] = start;
+            inChain[start] = true;
+            for (int i = 0; i < n; ++i)
+                for (int j = 0; j < links[chain[i]]; ++j) {
+                    const int next = link[chain[i]][j];
+                    if (color[next] >= 0) continue;
+                    color[next] = int8_t(1 - color[chain[i]]);
+                    chain[n++] = next;
+                    inChain[next] = true;
+                }
+
+            int falseColor = -1;
+            for (int i = 0; i < n && falseColor < 0; ++i)
+                for (int j = i + 1; j < n; ++j)
+                    if (color[chain[i]] == color[chain[j]] && CandidateGrid::sees(chain[i], chain[j])) {
+                        falseColor = color[chain[i]];
+                        break;
+                    }
+            int removed = 0;
+            if (falseColor >= 0) {
+                for (int i = 0; i < n; ++i)
+                    if (color[chain[i]] == falseColor) removed += removeFrom(g, chain[i], bit);
+            }
+            else {
+                for (int cell = 0; cell < 81; ++cell) {
+                    if (inChain[cell] || !(g.candidates(cell) & bit)) continue;
+                    bool seen[2] = { false, false };
+                    for (int i = 0; i < n; ++i)
+                        if (CandidateGrid::sees(cell, chain[i])) seen[color[chain[i]]] = true;
+                    if (seen[0] && seen[1]) removed += removeFrom(g, cell, bit);
+                }
+            }
+            if (eliminationStep(Strategy::SimpleColoring, removed, step)) return true;
+        }
+    }
+    return false;
+}
+
+}
+
+const std::vector<StrategyDef>& defaultStrategies()
+{
+    static const std::vector<StrategyDef> pipeline = {
+        { Strategy::HiddenSingle, "hidden single", 1.5, hiddenSingle },
+        { Strategy::NakedSingle, "naked single", 2.3, nakedSingle },
+        { Strategy::PointingPair, "pointing pair", 2.6, pointingPair },
+        { Strategy::BoxLineReduction, "box/line reduction", 2.8, boxLineReduction },
+        { Strategy::NakedPair, "naked pair", 3.0,
+            [](CandidateGrid& g, Step& s) { return nakedSubset(g, 2, Strategy::NakedPair, s); } },
+        { Strategy::XWing, "x-wing", 3.2, [](CandidateGrid& g, Step& s) { return fish(g, 2, Strategy::XWing, s); } },
+        { Strategy::HiddenPair, "hidden pair", 3.4,
+            [](CandidateGrid& g, Step& s) { return hiddenSubset(g, 2, Strategy::HiddenPair, s); } },
+        { Strategy::NakedTriple, "naked triple", 3.6,
+            [](CandidateGrid& g, Step& s) { return nakedSubset(g, 3, Strategy::NakedTriple, s); } },
+        { Strategy::Swordfish, "swordfish", 3.8, [](CandidateGrid& g, Step& s) { return fish(g, 3, Strategy::Swordfish, s); } },
+        { Strategy::HiddenTriple, "hidden triple", 4.0,
+            [](CandidateGrid& g, Step& s) { return hiddenSubset(g, 3, Strategy::HiddenTriple, s); } },
+        { Strategy::XYWing, "xy-wing", 4.2, xyWing },
+        { Strategy::SimpleColoring, "simple coloring", 4.5, simpleColoring },
+        { Strategy::NakedQuad, "naked quad", 5.0,
+            [](CandidateGrid& g, Step& s) { return nakedSubset(g, 4, Strategy::NakedQuad, s); } },
+        { Strategy::HiddenQuad, "hidden quad", 5.4,
+            [](CandidateGrid& g, Step& s) { return hiddenSubset(g, 4, Strategy::HiddenQuad, s); } },
+    };
+    return pipeline;
+}
+
+const StrategyDef* findStrategy(Strategy id)
+{
+    for (const auto& def : defaultStrategies())
+        if (def.id == id) return &def;
+    return nullptr;
+}
+
+const char* strategyName(Strategy id)
+{
+    const StrategyDef* def = findStrategy(id);
+    return def ? def->name : "none";
+}
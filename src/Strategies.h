@@ -0,0 +1,24 @@
+#pragma once
+#include <vector>
+#include "CandidateGrid.h"
+#include "Strategy.h"
+
+// One logical technique. `apply` makes at most one deduction on the grid (a placement
+// or one pattern's eliminations), describes it in `step` and returns false when the
+// technique finds nothing. `cost` is its weight on a Sudoku Explainer-like scale; a
+// puzzle's rating is the cost of the hardest step its solution path needs.
+struct StrategyDef {
+    Strategy id;
+    const char* name;
+    double cost;
+    bool (*apply)(CandidateGrid& grid, Step& step);
+};
+
+// Rating of a puzzle the pipeline cannot finish (trial and error needed).
+constexpr double kBeyondPipelineRating = 10.0;
+
+// All built-in strategies, cheapest first; this is the order logicalStep tries them.
+const std::vector<StrategyDef>& defaultStrategies();
+
+const StrategyDef* findStrategy(Strategy id);
+const char* strategyName(Strategy id);
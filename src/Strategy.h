@@ -1,4 +1,16 @@
 #pragma once
 
-enum class Strategy { NakedSingle, HiddenSingle, NakedPair, None };
-struct Step { Strategy strategy; int row, col, num; };
+// Logical techniques, roughly in order of difficulty. See Strategies.h for the
+// pipeline that applies them and their rating weights.
+enum class Strategy {
+    NakedSingle, HiddenSingle, NakedPair,
+    PointingPair, BoxLineReduction, HiddenPair, NakedTriple, HiddenTriple, NakedQuad, HiddenQuad,
+    XWing, Swordfish, XYWing, SimpleColoring,
+    None
+};
+
+// A placement (`num` at row/col) or, for elimination-only steps, row = col = -1 and
+// `eliminated` candidates removed from the grid.
+struct Step { Strategy strategy; int row, col, num; int eliminated = 0; };
+
+constexpr int kStrategyCount = int(Strategy::None);
@@ -1,28 +1,54 @@
 #include "SudokuBoard.h"
 
-SudokuBoard::SudokuBoard() : grid_(9, std::vector<int>(9, 0)) {}
+template <int BR, int BC>
+BasicBoard<BR, BC>::BasicBoard() : cells_{}, rows_{}, cols_{}, boxes_{} {}
 
-void SudokuBoard::setGrid(const std::vector<std::vector<int>>& newGrid) {
-    grid_ = newGrid;
+template <int BR, int BC>
+void BasicBoard<BR, BC>::setGrid(const std::vector<std::vector<int>>& newGrid) {
+    cells_.fill(0); rows_.fill(0); cols_.fill(0); boxes_.fill(0);
+    for (int r = 0; r < kSize; ++r)
+        for (int c = 0; c < kSize; ++c) {
+            int v = newGrid[r][c];
+            if (v < 1 || v > kSize) continue;
+            cells_[r * kSize + c] = uint8_t(v);
+            rows_[r] |= bit(v); cols_[c] |= bit(v); boxes_[boxOf(r, c)] |= bit(v);
+        }
 }
 
-const std::vector<std::vector<int>>& SudokuBoard::getGrid() const {
-    return grid_;
+template <int BR, int BC>
+std::vector<std::vector<int>> BasicBoard<BR, BC>::getGrid() const {
+    std::vector<std::vector<int>> grid(kSize, std::vector<int>(kSize, 0));
+    for (int r = 0; r < kSize; ++r)
+        for (int c = 0; c < kSize; ++c)
+            grid[r][c] = cells_[r * kSize + c];
+    return grid;
 }
 
-int SudokuBoard::at(int r, int c) const {
-    return grid_[r][c];
+template <int BR, int BC>
+void BasicBoard<BR, BC>::put(int r, int c, int v) {
+    int old = cells_[r * kSize + c];
+    if (old == v) return;
+    cells_[r * kSize + c] = uint8_t(v);
+    // Boards loaded from the UI may hold duplicates, so a removed digit can still be
+    // present elsewhere in the unit; recompute the three affected masks.
+    if (old != 0) rebuildMasks(r, c);
+    else { rows_[r] |= bit(v); cols_[c] |= bit(v); boxes_[boxOf(r, c)] |= bit(v); }
 }
 
-void SudokuBoard::put(int r, int c, int v) {
-    grid_[r][c] = v;
+template <int BR, int BC>
+void BasicBoard<BR, BC>::rebuildMasks(int r, int c) {
+    Mask row = 0, col = 0, box = 0;
+    int sr = r - r % BR, sc = c - c % BC;
+    for (int i = 0; i < kSize; ++i) {
+        if (int v = cells_[r * kSize + i]) row |= bit(v);
+        if (int v = cells_[i * kSize + c]) col |= bit(v);
+        if (int v = cells_[(sr + i / BC) * kSize + sc + i % BC]) box |= bit(v);
+    }
+    rows_[r] = row; cols_[c] = col; boxes_[boxOf(r, c)] = box;
 }
 
-bool SudokuBoard::isSafe(int row, int col, int num) const {
-    for (int i = 0; i < 9; ++i) if (grid_[row][i] == num || grid_[i][col] == num) return false;
-    int sr = row - row % 3, sc = col - col % 3;
-    for (int i = 0; i < 3; ++i)
-        for (int j = 0; j < 3; ++j)
-            if (grid_[sr + i][sc + j] == num) return false;
-    return true;
-}
+template class BasicBoard<2, 2>;
+template class BasicBoard<2, 3>;
+template class BasicBoard<3, 3>;
+template class BasicBoard<4, 4>;
+template class BasicBoard<5, 5>;
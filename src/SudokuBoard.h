@@ -1,15 +1,73 @@
 #pragma once
+#include <array>
+#include <cstdint>
+#include <type_traits>
 #include <vector>
 
-class SudokuBoard {
+// Smallest unsigned type with one bit per digit of an N-digit puzzle.
+template <int N>
+using DigitMask = std::conditional_t<(N <= 8), uint8_t, std::conditional_t<(N <= 16), uint16_t, uint32_t>>;
+
+// Fixed-size board for puzzles built from BoxRows x BoxCols boxes (N = BoxRows * BoxCols
+// digits): N*N cells plus N-bit occupancy masks per row, column and box. Digit n occupies
+// bit (n - 1). The whole object is trivially copyable.
+template <int BoxRows, int BoxCols>
+class BasicBoard {
 public:
-    SudokuBoard();
+    static constexpr int kBoxRows = BoxRows;
+    static constexpr int kBoxCols = BoxCols;
+    static constexpr int kSize = BoxRows * BoxCols;
+    static constexpr int kCells = kSize * kSize;
+    using Mask = DigitMask<kSize>;
+    static constexpr Mask kAllDigits = Mask((uint64_t(1) << kSize) - 1);
+
+    BasicBoard();
     void setGrid(const std::vector<std::vector<int>>& newGrid);
-    const std::vector<std::vector<int>>& getGrid() const;
-    int at(int r, int c) const;
+    std::vector<std::vector<int>> getGrid() const;
     void put(int r, int c, int v);
-    bool isSafe(int row, int col, int num) const;
+
+    int at(int r, int c) const { return cells_[r * kSize + c]; }
+    static int boxOf(int r, int c) { return (r / BoxRows) * BoxRows + c / BoxCols; }
+    static Mask bit(int num) { return Mask(1u << (num - 1)); }
+
+    Mask usedMask(int r, int c) const { return rows_[r] | cols_[c] | boxes_[boxOf(r, c)]; }
+    Mask candidates(int r, int c) const { return kAllDigits & ~usedMask(r, c); }
+    bool isSafe(int row, int col, int num) const { return !(usedMask(row, col) & bit(num)); }
+
+    // Unchecked fast path for search: place() requires an empty cell and a safe digit,
+    // clear() undoes a place() on a board without duplicate digits.
+    void place(int r, int c, int v) {
+        cells_[r * kSize + c] = uint8_t(v);
+        const Mask m = bit(v);
+        rows_[r] |= m; cols_[c] |= m; boxes_[boxOf(r, c)] |= m;
+    }
+    void clear(int r, int c) {
+        const Mask m = Mask(~bit(cells_[r * kSize + c]));
+        cells_[r * kSize + c] = 0;
+        rows_[r] &= m; cols_[c] &= m; boxes_[boxOf(r, c)] &= m;
+    }
+    // Loads a complete grid in one go; `cells` (row-major) must be a valid solution,
+    // which makes every mask full.
+    void setSolved(const uint8_t* cells) {
+        for (int i = 0; i < kCells; ++i) cells_[i] = cells[i];
+        rows_.fill(kAllDigits); cols_.fill(kAllDigits); boxes_.fill(kAllDigits);
+    }
 
 private:
-    std::vector<std::vector<int>> grid_;
+    std::array<uint8_t, kCells> cells_;
+    std::array<Mask, kSize> rows_, cols_, boxes_;
+
+    void rebuildMasks(int r, int c);
 };
+
+// Geometries instantiated in SudokuBoard.cpp: 4x4, 6x6, 9x9, 16x16 and 25x25.
+extern template class BasicBoard<2, 2>;
+extern template class BasicBoard<2, 3>;
+extern template class BasicBoard<3, 3>;
+extern template class BasicBoard<4, 4>;
+extern template class BasicBoard<5, 5>;
+
+using SudokuBoard = BasicBoard<3, 3>;
+
+static_assert(std::is_trivially_copyable_v<SudokuBoard>, "SudokuBoard must stay memcpy-able");
+static_assert(std::is_same_v<SudokuBoard::Mask, uint16_t>, "9x9 masks must stay 16-bit");
@@ -0,0 +1,43 @@
+#include "TraceCache.h"
+#include "CandidateSolver.h"
+
+TraceCache::TraceCache(size_t capacity) : capacity_(capacity ? capacity : 1) {}
+
+std::shared_ptr<const CachedTrace> TraceCache::get(const CanonicalForm& form)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        auto it = index_.find(form.key);
+        if (it != index_.end()) {
+            ++hits_;
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return it->second->second;
+        }
+        ++misses_;
+    }
+
+    // Two threads missing on the same puzzle both record it; the second store wins.
+    auto entry = std::make_shared<CachedTrace>();
+    entry->trace = SolveTrace::record(form.board);
+    CandidateSolver solver;
+    entry->solvable = solver.solve(form.board, 1, &entry->solution) > 0;
+
+    std::lock_guard<std::mutex> lock(m_);
+    auto it = index_.find(form.key);
+    if (it != index_.end()) {
+        it->second->second = entry;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return entry;
+    }
+    if (lru_.size() >= capacity_) {
+        index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+    lru_.emplace_front(form.key, entry);
+    index_.emplace(form.key, lru_.begin());
+    return entry;
+}
+
+size_t TraceCache::hits() const { std::lock_guard<std::mutex> lock(m_); return hits_; }
+size_t TraceCache::misses() const { std::lock_guard<std::mutex> lock(m_); return misses_; }
+size_t TraceCache::size() const { std::lock_guard<std::mutex> lock(m_); return lru_.size(); }
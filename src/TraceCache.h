@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "Canonical.h"
+#include "SolveTrace.h"
+
+// Solve trace of a puzzle's canonical board together with its solution. Recorded once
+// and never modified, so one copy serves every thread.
+struct CachedTrace {
+    SolveTrace trace;
+    bool solvable = false;
+    SudokuBoard solution;  // when solvable
+};
+
+// Bounded LRU of CachedTrace keyed by CanonicalKey, the trace counterpart of
+// PuzzleCache. Traces live in the canonical frame, so isomorphic puzzles share one;
+// callers map boards and hints through the CanonicalForm transform. Entries are handed
+// out as shared pointers and stay valid after eviction. Thread-safe.
+class TraceCache {
+public:
+    explicit TraceCache(size_t capacity = 1024);
+
+    TraceCache(const TraceCache&) = delete;
+    TraceCache& operator=(const TraceCache&) = delete;
+
+    // The entry for `form`, recorded (outside the lock) and stored on a miss.
+    std::shared_ptr<const CachedTrace> get(const CanonicalForm& form);
+
+    size_t hits() const;
+    size_t misses() const;
+    size_t size() const;
+    size_t capacity() const { return capacity_; }
+
+private:
+    using Lru = std::list<std::pair<CanonicalKey, std::shared_ptr<const CachedTrace>>>;
+
+    size_t capacity_;
+    mutable std::mutex m_;
+    Lru lru_;  // most recently used first
+    std::unordered_map<CanonicalKey, Lru::iterator, CanonicalKeyHash> index_;
+    size_t hits_ = 0, misses_ = 0;
+};
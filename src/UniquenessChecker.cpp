@@ -0,0 +1,52 @@
+#include "UniquenessChecker.h"
+
+template <int BR, int BC>
+void BasicUniquenessChecker<BR, BC>::reset(const Board& solution)
+{
+    puzzle_ = solution;
+    clues_ = 0;
+    for (int r = 0; r < Board::kSize; ++r)
+        for (int c = 0; c < Board::kSize; ++c)
+            if (puzzle_.at(r, c)) ++clues_;
+}
+
+template <int BR, int BC>
+bool BasicUniquenessChecker<BR, BC>::tryRemove(int r, int c)
+{
+    int v = puzzle_.at(r, c);
+    if (v == 0) return false;
+    puzzle_.clear(r, c);
+    if (solver_.hasSolutionExcluding(puzzle_, r * Board::kSize + c, v)) {
+        puzzle_.place(r, c, v);
+        return false;
+    }
+    --clues_;
+    return true;
+}
+
+template <int BR, int BC>
+bool BasicUniquenessChecker<BR, BC>::tryRemove(const int* cells, int n)
+{
+    int removed[Board::kCells], values[Board::kCells], k = 0;
+    for (int i = 0; i < n; ++i) {
+        const int r = cells[i] / Board::kSize, c = cells[i] % Board::kSize;
+        if (!puzzle_.at(r, c)) continue;
+        removed[k] = cells[i];
+        values[k++] = puzzle_.at(r, c);
+        puzzle_.clear(r, c);
+    }
+    if (k == 0) return false;
+    for (int i = 0; i < k; ++i) {
+        if (!solver_.hasSolutionExcluding(puzzle_, removed[i], values[i])) continue;
+        for (int j = 0; j < k; ++j) puzzle_.place(removed[j] / Board::kSize, removed[j] % Board::kSize, values[j]);
+        return false;
+    }
+    clues_ -= k;
+    return true;
+}
+
+template class BasicUniquenessChecker<2, 2>;
+template class BasicUniquenessChecker<2, 3>;
+template class BasicUniquenessChecker<3, 3>;
+template class BasicUniquenessChecker<4, 4>;
+template class BasicUniquenessChecker<5, 5>;
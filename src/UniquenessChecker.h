@@ -0,0 +1,45 @@
+#pragma once
+#include "CandidateSolver.h"
+#include "SudokuBoard.h"
+
+// Removes clues from a solved grid one at a time while keeping the solution unique.
+// The working puzzle and its occupancy masks persist across removals. Since the puzzle
+// was unique before a removal, any second solution must put a different digit in the
+// cell just emptied, so each check is one search with the known value excluded there.
+// A rejected removal is undone by placing the digit back.
+template <int BoxRows, int BoxCols>
+class BasicUniquenessChecker {
+public:
+    using Board = BasicBoard<BoxRows, BoxCols>;
+
+    BasicUniquenessChecker() = default;
+    explicit BasicUniquenessChecker(const Board& solution) { reset(solution); }
+
+    // Starts over from another solved grid, keeping the solver's search stack.
+    void reset(const Board& solution);
+    // Search counters of later checks are added to `stats` (nullptr detaches).
+    void setStats(SearchStats* stats) { solver_.setStats(stats); }
+
+    // Empties (r, c) if the puzzle stays uniquely solvable; returns whether it did.
+    bool tryRemove(int r, int c);
+    // Empties the given cells (row * N + col) together, or none of them. Any second
+    // solution differs from the known one in a cell just emptied, so this is one
+    // excluded-value search per emptied cell. Already empty cells are ignored.
+    bool tryRemove(const int* cells, int n);
+
+    const Board& puzzle() const { return puzzle_; }
+    int clues() const { return clues_; }
+
+private:
+    Board puzzle_;
+    BasicCandidateSolver<BoxRows, BoxCols> solver_;
+    int clues_ = Board::kCells;
+};
+
+extern template class BasicUniquenessChecker<2, 2>;
+extern template class BasicUniquenessChecker<2, 3>;
+extern template class BasicUniquenessChecker<3, 3>;
+extern template class BasicUniquenessChecker<4, 4>;
+extern template class BasicUniquenessChecker<5, 5>;
+
+using UniquenessChecker = BasicUniquenessChecker<3, 3>;
@@ -0,0 +1,93 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+namespace {
+thread_local const WorkStealingPool* tlsPool = nullptr;
+thread_local unsigned tlsWorker = 0;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned threads)
+{
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threads; ++i) queues_.push_back(std::make_unique<Queue>());
+    for (unsigned i = 0; i < threads; ++i) threads_.emplace_back([this, i] { workerLoop(i); });
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    wait();
+    { std::lock_guard<std::mutex> lk(m_); stop_ = true; }
+    work_.notify_all();
+    for (auto& t : threads_) t.join();
+}
+
+void WorkStealingPool::submit(Task task)
+{
+    unsigned target = tlsPool == this ? tlsWorker : nextQueue_++ % size();
+    ++pending_;
+    ++queued_;
+    {
+        std::lock_guard<std::mutex> lk(queues_[target]->m);
+        queues_[target]->tasks.push_back(std::move(task));
+    }
+    // A worker registers as a sleeper before it checks queued_, so either it sees the
+    // task or this sees it. Taking m_ orders the wake-up after its check.
+    if (sleepers_ > 0) {
+        { std::lock_guard<std::mutex> lk(m_); }
+        work_.notify_one();
+    }
+}
+
+void WorkStealingPool::wait()
+{
+    std::unique_lock<std::mutex> lk(m_);
+    idle_.wait(lk, [this] { return pending_ == 0; });
+}
+
+bool WorkStealingPool::tryPop(unsigned self, Task& task)
+{
+    {
+        Queue& own = *queues_[self];
+        std::lock_guard<std::mutex> lk(own.m);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (unsigned k = 1; k < size(); ++k) {
+        Queue& victim = *queues_[(self + k) % size()];
+        std::lock_guard<std::mutex> lk(victim.m);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(unsigned self)
+{
+    tlsPool = this;
+    tlsWorker = self;
+    Task task;
+    for (;;) {
+        if (tryPop(self, task)) {
+            --queued_;
+            task(self);
+            task = nullptr;
+            if (--pending_ == 0) {
+                std::lock_guard<std::mutex> lk(m_);
+                idle_.notify_all();
+            }
+            continue;
+        }
+        // queued_ may be up before the task reaches a deque; then the pop is retried.
+        std::unique_lock<std::mutex> lk(m_);
+        ++sleepers_;
+        work_.wait(lk, [this] { return stop_ || queued_ > 0; });
+        --sleepers_;
+        if (stop_ && queued_ == 0) return;
+    }
+}
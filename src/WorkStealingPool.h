@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each owning a task deque. Owners pop from the back of
+// their own deque; idle workers steal from the front of the others. Tasks receive the
+// index of the worker running them so callers can keep per-worker state without locks.
+class WorkStealingPool {
+public:
+    using Task = std::function<void(unsigned worker)>;
+
+    explicit WorkStealingPool(unsigned threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned size() const { return unsigned(threads_.size()); }
+
+    // Tasks submitted from inside a worker go to that worker's own deque.
+    void submit(Task task);
+    // Blocks until every submitted task has finished.
+    void wait();
+
+private:
+    struct alignas(64) Queue {
+        std::mutex m;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    // m_ guards only the sleep/wake path (and stop_): submit and the workers' pops
+    // touch the atomics below, and take m_ just to wake a sleeper or to go to sleep.
+    std::mutex m_;
+    std::condition_variable work_, idle_;
+    // Raised before a task is published to a deque and lowered after it is popped, so
+    // it never underflows; a worker only sleeps while it is zero.
+    std::atomic<size_t> queued_{ 0 };
+    std::atomic<unsigned> sleepers_{ 0 };
+    std::atomic<size_t> pending_{ 0 };
+    std::atomic<unsigned> nextQueue_{ 0 };
+    bool stop_ = false;
+
+    bool tryPop(unsigned self, Task& task);
+    void workerLoop(unsigned self);
+};
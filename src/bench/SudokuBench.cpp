@@ -0,0 +1,426 @@
+// Benchmarks the Service entry points over the bundled puzzle corpora.
+//
+//   sudoku_bench [--data=DIR] [--filter=TEXT] [--min-time=SECONDS] [--budget=SECONDS]
+//                [--gen-count=N] [--csv=FILE] [--baseline=FILE] [--threshold=FRACTION]
+//                [--simd=scalar|sse2|avx2]
+//   sudoku_bench --check [--data=DIR] [--gen-count=N]
+//
+// Each benchmark runs one entry point over one corpus (or generates --gen-count
+// puzzles, or samples 1000 filled grids per call) and reports throughput, per-call
+// latency percentiles and search nodes per puzzle. rateBatch rates a whole corpus per
+// call through RatingPipeline; its work column is the boards that reached the
+// backtracking stage. Small corpora are repeated until --min-time has elapsed; a
+// benchmark stops early, possibly part-way through a pass, once it has used its
+// --budget. --csv writes the results in the same format --baseline reads back; with a
+// baseline, any benchmark whose throughput falls more than --threshold (default 0.10)
+// below it fails the run. --simd caps the vector kernel level (default: widest the CPU
+// has). Built with SUDOKU_COUNT_ALLOCATIONS, it also counts heap allocations per call
+// after a warm-up call and fails the run if any benchmark allocates in steady state.
+//
+// --check runs no benchmarks: it verifies that every strategy's deductions agree with
+// the solution of each uniquely solvable input and that RatingPipeline rates each
+// input as Service::rateDifficulty() does, and exits 1 on any mismatch.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "AllocationCounter.h"
+#include "CandidateSolver.h"
+#include "GridSampler.h"
+#include "PuzzleIO.h"
+#include "RatingPipeline.h"
+#include "Service.h"
+#include "SimdKernels.h"
+
+#ifndef SUDOKU_BENCH_DATA_DIR
+#define SUDOKU_BENCH_DATA_DIR "bench/data"
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint64_t kGenerateSeed = 0x5eed;
+
+struct Options {
+    std::string dataDir = SUDOKU_BENCH_DATA_DIR;
+    std::string filter;
+    std::string csvPath;
+    std::string baselinePath;
+    double minTime = 0.5;
+    double budget = 2.0;
+    double threshold = 0.10;
+    int genCount = 50;
+    bool check = false;
+};
+
+struct Result {
+    std::string benchmark, corpus;
+    size_t calls = 0;
+    double seconds = 0;
+    double p50Us = 0, p99Us = 0, maxUs = 0;
+    double nodesPerCall = 0;  // negative: the entry point has no work counter
+    double allocsPerCall = 0;
+
+    double perSecond() const { return seconds > 0 ? calls / seconds : 0; }
+};
+
+// One timed call. Returns the work counter for the call (search nodes or steps), or
+// kNoWork when the entry point has none.
+using Call = std::function<uint64_t(const SudokuBoard&)>;
+
+constexpr uint64_t kNoWork = ~uint64_t(0);
+
+std::vector<SudokuBoard> loadCorpus(const std::string& path)
+{
+    std::vector<SudokuBoard> out;
+    std::ifstream in(path);
+    std::string line;
+    SudokuBoard b;
+    while (std::getline(in, line))
+        if (!line.empty() && line[0] != '#' && parsePuzzleLine(line, b)) out.push_back(b);
+    return out;
+}
+
+Result measure(const std::string& name, const std::string& corpus, const std::vector<SudokuBoard>& inputs,
+    const Options& opt, const Call& call)
+{
+    Result r{ name, corpus };
+    std::vector<double> latencies;
+    uint64_t work = 0, allocs = 0;
+    bool counted = true;
+    // First-call setup (per-thread engines, scratch buffers) is not steady state.
+    if (SUDOKU_ALLOCATIONS_COUNTED && !inputs.empty()) call(inputs.front());
+    const auto start = Clock::now();
+    double elapsed = 0;
+    do {
+        for (const auto& b : inputs) {
+            const uint64_t a0 = threadAllocations();
+            const auto t0 = Clock::now();
+            const uint64_t w = call(b);
+            const auto t1 = Clock::now();
+            if (w == kNoWork) counted = false;
+            else work += w;
+            allocs += threadAllocations() - a0;
+            latencies.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+            elapsed = std::chrono::duration<double>(t1 - start).count();
+            if (elapsed > opt.budget) break;
+        }
+    } while (!inputs.empty() && elapsed < opt.minTime);
+    r.calls = latencies.size();
+    r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (r.calls == 0) return r;
+    std::sort(latencies.begin(), latencies.end());
+    auto pct = [&](double p) { return latencies[std::min(latencies.size() - 1, size_t(p * latencies.size()))]; };
+    r.p50Us = pct(0.50);
+    r.p99Us = pct(0.99);
+    r.maxUs = latencies.back();
+    r.nodesPerCall = counted ? double(work) / r.calls : -1;
+    r.allocsPerCall = double(allocs) / r.calls;
+    return r;
+}
+
+Call solveWith(Engine engine)
+{
+    return [engine](const SudokuBoard& b) {
+        SearchStats stats;
+        Service s(engine); s.setStats(&stats); s.loadBoard(b); s.solve();
+        return stats.nodes;
+    };
+}
+
+Call countWith(Engine engine)
+{
+    return [engine](const SudokuBoard& b) {
+        SearchStats stats;
+        Service s(engine); s.setStats(&stats); s.loadBoard(b); s.countSolutions(2);
+        return stats.nodes;
+    };
+}
+
+uint64_t logicalSolveCall(const SudokuBoard& b)
+{
+    Service s; s.loadBoard(b);
+    thread_local std::vector<Step> steps;
+    steps.clear();
+    steps.reserve(1024);
+    s.logicalSolve(steps);
+    return steps.size();
+}
+
+// Rating runs no search, so there are no nodes to report.
+uint64_t classifyCall(const SudokuBoard& b)
+{
+    Service s; s.loadBoard(b); s.classifyDifficulty();
+    return kNoWork;
+}
+
+// Steps the default pipeline on a puzzle with the unique solution `solution` and checks
+// after every deduction that each placement and every remaining candidate set still
+// agree with it. Returns the strategy that broke that, or nullptr.
+const StrategyDef* unsoundStep(const SudokuBoard& puzzle, const SudokuBoard& solution, std::vector<uint64_t>& hits)
+{
+    CandidateGrid grid;
+    grid.load(puzzle);
+    Step step;
+    for (bool progress = true; progress;) {
+        progress = false;
+        for (const auto& def : defaultStrategies()) {
+            if (!def.apply(grid, step)) continue;
+            ++hits[&def - defaultStrategies().data()];
+            for (int cell = 0; cell < 81; ++cell) {
+                const int want = solution.at(cell / 9, cell % 9);
+                if (grid.value(cell) ? grid.value(cell) != want : !(grid.candidates(cell) & SudokuBoard::bit(want)))
+                    return &def;
+            }
+            progress = true;
+            break;
+        }
+    }
+    return nullptr;
+}
+
+// --check: every default strategy stays sound on the uniquely solvable inputs, and
+// RatingPipeline rates every input, broken variants included, exactly as
+// Service::rateDifficulty() does. Inputs are the corpora, --gen-count seeded puzzles
+// per difficulty plus as many minimal ones, and for each of those a copy with one clue
+// fewer and one with a clashing clue added. Returns the exit status.
+int selfCheck(const Options& opt)
+{
+    std::vector<SudokuBoard> inputs;
+    for (const char* corpus : { "easy", "17clue", "hard" }) {
+        const auto puzzles = loadCorpus(opt.dataDir + "/" + corpus + ".txt");
+        if (puzzles.empty()) std::cerr << "no puzzles in " << opt.dataDir << "/" << corpus << ".txt\n";
+        inputs.insert(inputs.end(), puzzles.begin(), puzzles.end());
+    }
+    Service generator(Engine::Candidates);
+    GenerateOptions minimal;
+    minimal.minimal = true;
+    for (int d = 1; d <= 4; ++d) {
+        Rng rng(kGenerateSeed, uint64_t(d));
+        for (int i = 0; i < opt.genCount; ++i) {
+            SudokuBoard b;
+            if (d <= 3) b = generator.generateBoard(d, rng);
+            else generator.generateBoard(minimal, rng, b);
+            inputs.push_back(b);
+        }
+    }
+    const size_t proper = inputs.size();
+    for (size_t i = 0; i < proper; ++i) {
+        SudokuBoard fewer = inputs[i], clash = inputs[i];
+        for (int cell = 0; cell < 81; ++cell) {
+            if (fewer.at(cell / 9, cell % 9)) { fewer.put(cell / 9, cell % 9, 0); break; }
+        }
+        for (int cell = 80; cell >= 0; --cell) {
+            const int r = cell / 9, c = cell % 9;
+            if (clash.at(r, c)) continue;
+            // A digit already in the row: the copy has no solution.
+            for (int k = 0; k < 9; ++k)
+                if (const int v = clash.at(r, k)) { clash.put(r, c, v); break; }
+            break;
+        }
+        inputs.push_back(fewer);
+        inputs.push_back(clash);
+    }
+
+    int failures = 0;
+    std::vector<uint64_t> hits(defaultStrategies().size());
+    size_t unique = 0;
+    CandidateSolver solver;
+    for (const auto& b : inputs) {
+        SudokuBoard solution;
+        if (solver.solve(b, 2, &solution) != 1) continue;
+        ++unique;
+        if (const StrategyDef* def = unsoundStep(b, solution, hits)) {
+            std::printf("unsound %s: %s\n", def->name, toPuzzleLine(b).c_str());
+            ++failures;
+        }
+    }
+
+    RatingPipeline pipeline;
+    std::vector<PuzzleRating> ratings(inputs.size());
+    pipeline.rate(inputs.data(), inputs.size(), ratings.data());
+    Service single;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        single.loadBoard(inputs[i]);
+        const double want = single.rateDifficulty();
+        if (ratings[i].rating != want) {
+            std::printf("rating %.1f, rateDifficulty %.1f: %s\n", ratings[i].rating, want, toPuzzleLine(inputs[i]).c_str());
+            ++failures;
+        }
+    }
+
+    std::printf("%zu inputs, %zu uniquely solvable; steps checked per strategy:\n", inputs.size(), unique);
+    for (size_t k = 0; k < hits.size(); ++k)
+        std::printf("  %-20s %llu\n", defaultStrategies()[k].name, (unsigned long long)hits[k]);
+    for (int stage = 0; stage < RatingPipeline::kStages; ++stage)
+        std::printf("  stage %-14s %llu settled\n", RatingPipeline::stageName(stage),
+            (unsigned long long)pipeline.counters()[stage].settled);
+    std::printf("%s: %d mismatch%s\n", failures ? "FAILED" : "ok", failures, failures == 1 ? "" : "es");
+    return failures ? 1 : 0;
+}
+
+bool parseArgs(int argc, char* argv[], Options& opt)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto value = [&](const char* key) { return a.substr(std::string(key).size()); };
+        if (a.rfind("--data=", 0) == 0) opt.dataDir = value("--data=");
+        else if (a.rfind("--filter=", 0) == 0) opt.filter = value("--filter=");
+        else if (a.rfind("--min-time=", 0) == 0) opt.minTime = std::atof(value("--min-time=").c_str());
+        else if (a.rfind("--budget=", 0) == 0) opt.budget = std::atof(value("--budget=").c_str());
+        else if (a.rfind("--gen-count=", 0) == 0) opt.genCount = std::atoi(value("--gen-count=").c_str());
+        else if (a.rfind("--csv=", 0) == 0) opt.csvPath = value("--csv=");
+        else if (a.rfind("--baseline=", 0) == 0) opt.baselinePath = value("--baseline=");
+        else if (a.rfind("--threshold=", 0) == 0) opt.threshold = std::atof(value("--threshold=").c_str());
+        else if (a == "--check") opt.check = true;
+        else if (a == "--simd=scalar") setSimdLevel(SimdLevel::Scalar);
+        else if (a == "--simd=sse2") setSimdLevel(SimdLevel::Sse2);
+        else if (a == "--simd=avx2") setSimdLevel(SimdLevel::Avx2);
+        else return false;
+    }
+    return true;
+}
+
+const char* kCsvHeader = "benchmark,corpus,calls,seconds,per_second,p50_us,p99_us,max_us,nodes_per_call";
+
+void writeCsv(const std::string& path, const std::vector<Result>& results)
+{
+    std::ofstream out(path);
+    out << kCsvHeader << '\n';
+    for (const auto& r : results) {
+        out << r.benchmark << ',' << r.corpus << ',' << r.calls << ',' << r.seconds << ',' << r.perSecond() << ','
+            << r.p50Us << ',' << r.p99Us << ',' << r.maxUs << ',';
+        if (r.nodesPerCall < 0) out << "n/a\n";
+        else out << r.nodesPerCall << '\n';
+    }
+}
+
+std::map<std::string, double> readBaseline(const std::string& path)
+{
+    std::map<std::string, double> out;
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    while (std::getline(in, line)) {
+        std::stringstream ss(line);
+        std::string name, corpus, field;
+        std::getline(ss, name, ',');
+        std::getline(ss, corpus, ',');
+        for (int i = 0; i < 3; ++i) std::getline(ss, field, ',');
+        out[name + "/" + corpus] = std::atof(field.c_str());
+    }
+    return out;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        std::cerr << "usage: sudoku_bench [--data=DIR] [--filter=TEXT] [--min-time=SECONDS] [--budget=SECONDS]\n"
+                     "                    [--gen-count=N] [--csv=FILE] [--baseline=FILE] [--threshold=FRACTION]\n"
+                     "                    [--simd=scalar|sse2|avx2]\n"
+                     "       sudoku_bench --check [--data=DIR] [--gen-count=N]\n";
+        return 2;
+    }
+
+    std::fprintf(stderr, "vector kernels: %s\n", simdLevelName(simdLevel()));
+    if (opt.check) return selfCheck(opt);
+
+    const std::vector<std::pair<std::string, Call>> entryPoints = {
+        { "solve/backtrack", solveWith(Engine::Backtracking) },
+        { "solve/dlx", solveWith(Engine::DancingLinks) },
+        { "solve/mrv", solveWith(Engine::Candidates) },
+        { "count2/backtrack", countWith(Engine::Backtracking) },
+        { "count2/mrv", countWith(Engine::Candidates) },
+        { "logicalSolve", logicalSolveCall },
+        { "classifyDifficulty", classifyCall },
+    };
+
+    std::vector<Result> results;
+    auto report = [&](const Result& r) {
+        std::printf("%-20s %-8s %7zu calls %12.0f /s  p50 %9.1f us  p99 %9.1f us  max %9.1f us",
+            r.benchmark.c_str(), r.corpus.c_str(), r.calls, r.perSecond(), r.p50Us, r.p99Us, r.maxUs);
+        if (r.nodesPerCall < 0) std::printf("  %10s nodes", "n/a");
+        else std::printf("  %10.1f nodes", r.nodesPerCall);
+        if (SUDOKU_ALLOCATIONS_COUNTED) std::printf("  %6.2f allocs", r.allocsPerCall);
+        std::printf("\n");
+        std::fflush(stdout);
+        results.push_back(r);
+    };
+    auto selected = [&](const std::string& name, const std::string& corpus) {
+        return opt.filter.empty() || (name + "/" + corpus).find(opt.filter) != std::string::npos;
+    };
+
+    for (const char* corpus : { "easy", "17clue", "hard" }) {
+        auto puzzles = loadCorpus(opt.dataDir + "/" + corpus + ".txt");
+        if (puzzles.empty()) { std::cerr << "no puzzles in " << opt.dataDir << "/" << corpus << ".txt\n"; continue; }
+        for (const auto& [name, call] : entryPoints)
+            if (selected(name, corpus)) report(measure(name, corpus, puzzles, opt, call));
+        if (selected("rateBatch", corpus)) {
+            RatingPipeline pipeline;
+            std::vector<PuzzleRating> ratings(puzzles.size());
+            report(measure("rateBatch", corpus, { SudokuBoard() }, opt, [&](const SudokuBoard&) {
+                pipeline.rate(puzzles.data(), puzzles.size(), ratings.data());
+                return uint64_t(std::count_if(ratings.begin(), ratings.end(),
+                    [](const PuzzleRating& r) { return r.stage == RatingPipeline::Backtracking; }));
+            }));
+        }
+    }
+
+    const std::vector<SudokuBoard> genSlots(size_t(std::max(0, opt.genCount)));
+    for (int d = 1; d <= 3; ++d) {
+        const std::string corpus = d == 1 ? "easy" : d == 2 ? "medium" : "hard";
+        if (!selected("generatePuzzle", corpus)) continue;
+        // Fixed seed: every run times the same sequence of puzzles.
+        Rng rng(kGenerateSeed, uint64_t(d));
+        report(measure("generatePuzzle", corpus, genSlots, opt, [d, &rng](const SudokuBoard&) {
+            SearchStats stats;
+            Service s(Engine::Candidates); s.setStats(&stats); s.generateBoard(d, rng);
+            return stats.nodes;
+        }));
+    }
+
+    if (selected("sampleGrid", "x1000")) {
+        GridSampler::shared();
+        Rng rng(kGenerateSeed);
+        report(measure("sampleGrid", "x1000", genSlots, opt, [&rng](const SudokuBoard&) {
+            SudokuBoard grid;
+            for (int i = 0; i < 1000; ++i) GridSampler::shared().sample(rng, grid);
+            return uint64_t(grid.at(0, 0) != 0);
+        }));
+    }
+
+    if (!opt.csvPath.empty()) writeCsv(opt.csvPath, results);
+
+    int status = 0;
+    for (const auto& r : results)
+        if (r.allocsPerCall > 0) {
+            std::fprintf(stderr, "%s/%s allocates %.3g times per call in steady state\n",
+                r.benchmark.c_str(), r.corpus.c_str(), r.allocsPerCall);
+            status = 1;
+        }
+    if (!opt.baselinePath.empty()) {
+        const auto baseline = readBaseline(opt.baselinePath);
+        std::printf("\n%-30s %12s %12s %8s\n", "vs baseline", "baseline/s", "current/s", "ratio");
+        for (const auto& r : results) {
+            auto it = baseline.find(r.benchmark + "/" + r.corpus);
+            if (it == baseline.end() || it->second <= 0) continue;
+            double ratio = r.perSecond() / it->second;
+            bool regressed = ratio < 1.0 - opt.threshold;
+            std::printf("%-30s %12.0f %12.0f %7.2fx%s\n", (r.benchmark + "/" + r.corpus).c_str(),
+                it->second, r.perSecond(), ratio, regressed ? "  REGRESSION" : "");
+            if (regressed) status = 1;
+        }
+    }
+    return status;
+}
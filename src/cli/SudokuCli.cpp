@@ -0,0 +1,307 @@
+// Headless batch front end: reads 81-character puzzles line by line from stdin or the
+// given files and writes one result line per puzzle, in input order.
+//
+//   sudoku_cli [--count[=N] | --rate] [--engine=mrv|dlx|backtrack] [--box=RxC] [--threads=N] [--stats] [--work] [--cache=N] [file...]
+//   sudoku_cli --count=all | --enumerate[=N] [--split=D] [--box=RxC] [--threads=N] [file...]
+//   sudoku_cli --generate=N [--difficulty=1|2|3] [--seed=S [--first=I]] [--threads=N]
+//              [--symmetry=rot180|rot90|mirror|diagonal] [--minimal | --clues=N] [--rating=MIN[-MAX]]
+//   sudoku_cli --pack=OUT.sdkb [file] | --unpack [file.sdkb...]
+//
+// Solve mode prints the solved grid (or "none"); count mode prints the number of
+// solutions found, capped at N (default 2); --rate prints the logical difficulty rating
+// (1.5-5.4, or 10.0 when the strategy pipeline gets stuck). Blank lines and lines
+// starting with '#' are skipped; malformed lines produce "invalid". Puzzles are solved
+// on all cores unless --threads is given; --stats reports per-thread throughput on
+// stderr, and with --rate the boards entering and settled by each RatingPipeline stage.
+// --box selects another geometry (2x2, 2x3, 4x4, 5x5 boxes); larger boards write values
+// 10-25 as letters A-P. --generate writes N fresh 9x9 puzzles of the given difficulty
+// (default 2) instead; with --seed the output is reproducible whatever the thread
+// count, and --first=I starts at puzzle I of that seed's sequence. --symmetry removes
+// clues in symmetric orbits, --minimal removes until no clue can go, --clues sets the
+// clue target in place of --difficulty and --rating keeps only puzzles whose rating
+// lies in range; the index of each puzzle for which no grid qualified is reported on
+// stderr. --work appends each puzzle's search nodes, backtracks and maximum depth to
+// its result line, tab-separated, to pick out pathological inputs.
+// --cache=N remembers the results of the last N distinct 9x9 puzzles up to symmetry and
+// digit relabelling, so repeated and isomorphic puzzles are answered from the cache.
+// --pack converts text (optionally "puzzle,solution" lines) to the binary corpus format
+// of BinaryCorpus.h and --unpack converts back; binary corpora given as input files are
+// memory-mapped and solved without parsing.
+// --count=all counts every solution and --enumerate writes them (at most N), followed by
+// a "# N solutions" line; both take one puzzle at a time and split its search tree
+// D branching levels deep (default: automatic) across the threads (SolutionCounter.h).
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include "BatchSolver.h"
+#include "PuzzleGenerator.h"
+#include "PuzzleIO.h"
+#include "SolutionCounter.h"
+
+namespace {
+
+struct Options {
+    BatchOptions batch;
+    unsigned threads = 0;
+    bool stats = false;
+    size_t cache = 0;
+    std::string pack;
+    bool unpack = false;
+    bool countAll = false;
+    bool enumerate = false;
+    uint64_t enumerateLimit = 0;
+    int splitDepth = 0;
+    size_t generate = 0;
+    int difficulty = 2;
+    bool seeded = false;
+    uint64_t seed = 0;
+    uint64_t first = 0;
+    GenerateOptions shape;
+    bool shaped = false;     // any of --symmetry/--minimal/--clues/--rating
+    std::vector<std::string> files;
+};
+
+void usage()
+{
+    std::cerr << "usage: sudoku_cli [--count[=N] | --rate] [--engine=mrv|dlx|backtrack] [--box=RxC] [--threads=N] [--stats] [--work] [--cache=N] [file...]\n"
+                 "       sudoku_cli --count=all | --enumerate[=N] [--split=D] [--box=RxC] [--threads=N] [file...]\n"
+                 "       sudoku_cli --generate=N [--difficulty=1|2|3] [--seed=S [--first=I]] [--threads=N]\n"
+                 "                  [--symmetry=rot180|rot90|mirror|diagonal] [--minimal | --clues=N] [--rating=MIN[-MAX]]\n"
+                 "       sudoku_cli --pack=OUT.sdkb [file] | --unpack [file.sdkb...]\n";
+}
+
+bool parseArgs(int argc, char* argv[], Options& opt)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--count") opt.batch.count = true;
+        else if (a == "--count=all") opt.countAll = true;
+        else if (a.rfind("--count=", 0) == 0) { opt.batch.count = true; opt.batch.limit = std::atoi(a.c_str() + 8); }
+        else if (a == "--rate") opt.batch.rate = true;
+        else if (a == "--engine=mrv") opt.batch.engine = Engine::Candidates;
+        else if (a == "--engine=dlx") opt.batch.engine = Engine::DancingLinks;
+        else if (a == "--engine=backtrack") opt.batch.engine = Engine::Backtracking;
+        else if (a.rfind("--threads=", 0) == 0) opt.threads = unsigned(std::atoi(a.c_str() + 10));
+        else if (a == "--stats") opt.stats = true;
+        else if (a == "--work") opt.batch.work = true;
+        else if (a.rfind("--cache=", 0) == 0) opt.cache = size_t(std::strtoull(a.c_str() + 8, nullptr, 10));
+        else if (a.rfind("--box=", 0) == 0) {
+            if (std::sscanf(a.c_str() + 6, "%dx%d", &opt.batch.boxRows, &opt.batch.boxCols) != 2 ||
+                !BatchSolver::supportsGeometry(opt.batch.boxRows, opt.batch.boxCols)) {
+                std::cerr << "unsupported box geometry " << (a.c_str() + 6) << "\n";
+                return false;
+            }
+        }
+        else if (a.rfind("--generate=", 0) == 0) opt.generate = size_t(std::atoll(a.c_str() + 11));
+        else if (a.rfind("--pack=", 0) == 0) opt.pack = a.substr(7);
+        else if (a == "--unpack") opt.unpack = true;
+        else if (a == "--enumerate") opt.enumerate = true;
+        else if (a.rfind("--enumerate=", 0) == 0) { opt.enumerate = true; opt.enumerateLimit = std::strtoull(a.c_str() + 12, nullptr, 10); }
+        else if (a.rfind("--split=", 0) == 0) opt.splitDepth = std::atoi(a.c_str() + 8);
+        else if (a.rfind("--difficulty=", 0) == 0) opt.difficulty = std::atoi(a.c_str() + 13);
+        else if (a.rfind("--seed=", 0) == 0) { opt.seeded = true; opt.seed = std::strtoull(a.c_str() + 7, nullptr, 10); }
+        else if (a.rfind("--first=", 0) == 0) opt.first = std::strtoull(a.c_str() + 8, nullptr, 10);
+        else if (a.rfind("--symmetry=", 0) == 0) {
+            const std::string name = a.substr(11);
+            opt.shaped = true;
+            if (name == "none") opt.shape.symmetry = Symmetry::None;
+            else if (name == "rot180") opt.shape.symmetry = Symmetry::Rotational180;
+            else if (name == "rot90") opt.shape.symmetry = Symmetry::Rotational90;
+            else if (name == "mirror") opt.shape.symmetry = Symmetry::Mirror;
+            else if (name == "diagonal") opt.shape.symmetry = Symmetry::Diagonal;
+            else { std::cerr << "unknown symmetry " << name << "\n"; return false; }
+        }
+        else if (a == "--minimal") { opt.shaped = true; opt.shape.minimal = true; }
+        else if (a.rfind("--clues=", 0) == 0) { opt.shaped = true; opt.shape.clues = std::atoi(a.c_str() + 8); }
+        else if (a.rfind("--rating=", 0) == 0) {
+            opt.shaped = true;
+            if (std::sscanf(a.c_str() + 9, "%lf-%lf", &opt.shape.minRating, &opt.shape.maxRating) < 1) {
+                std::cerr << "bad rating range " << (a.c_str() + 9) << "\n";
+                return false;
+            }
+        }
+        else if (a == "-h" || a == "--help") return false;
+        else if (a.size() > 1 && a[0] == '-') { std::cerr << "unknown option " << a << "\n"; return false; }
+        else opt.files.push_back(a);
+    }
+    if (!opt.pack.empty() && opt.files.size() > 1) { std::cerr << "--pack takes one input\n"; return false; }
+    if (opt.batch.limit < 1) { std::cerr << "--count limit must be positive\n"; return false; }
+    if (opt.batch.rate && (opt.batch.boxRows != 3 || opt.batch.boxCols != 3)) {
+        std::cerr << "--rate supports 9x9 puzzles only\n";
+        return false;
+    }
+    return true;
+}
+
+bool isEmpty(const SudokuBoard& b)
+{
+    for (int i = 0; i < 81; ++i)
+        if (b.at(i / 9, i % 9)) return false;
+    return true;
+}
+
+// --count=all / --enumerate for one puzzle.
+template <int BR, int BC>
+void countAll(BasicSolutionCounter<BR, BC>& counter, const BasicBoard<BR, BC>& board, const Options& opt, std::ostream& out)
+{
+    if (!opt.enumerate) { out << counter.count(board) << '\n'; return; }
+    std::mutex m;
+    const uint64_t n = counter.enumerate(board, [&](const BasicBoard<BR, BC>& solution) {
+        const std::string line = toPuzzleLine(solution);
+        std::lock_guard<std::mutex> lk(m);
+        out << line << '\n';
+        return true;
+    }, opt.enumerateLimit);
+    out << "# " << n << " solutions\n";
+}
+
+template <int BR, int BC>
+int countAllInputs(const Options& opt)
+{
+    BasicSolutionCounter<BR, BC> counter(opt.threads);
+    counter.setSplitDepth(opt.splitDepth);
+    int status = 0;
+    for (const auto& path : opt.files) {
+        if (path != "-" && MappedCorpus::isCorpusFile(path)) {
+            if constexpr (BR == 3 && BC == 3) {
+                MappedCorpus corpus;
+                if (!corpus.open(path)) { std::cerr << corpus.error() << "\n"; status = 1; continue; }
+                for (uint64_t i = 0; i < corpus.size(); ++i) countAll(counter, corpus.puzzle(i).board(), opt, std::cout);
+            }
+            else {
+                std::cerr << "binary corpora are 9x9 only\n";
+                status = 1;
+            }
+            continue;
+        }
+        std::ifstream file;
+        if (path != "-") {
+            file.open(path);
+            if (!file) { std::cerr << "cannot open " << path << "\n"; status = 1; continue; }
+        }
+        std::istream& in = file.is_open() ? file : std::cin;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#' || line == "\r") continue;
+            BasicBoard<BR, BC> board;
+            if (!parsePuzzleLine(line, board)) { std::cout << "invalid\n"; continue; }
+            countAll(counter, board, opt, std::cout);
+        }
+    }
+    return status;
+}
+
+int countAllInputs(const Options& opt, int boxRows, int boxCols)
+{
+    if (boxRows == 2 && boxCols == 2) return countAllInputs<2, 2>(opt);
+    if (boxRows == 2 && boxCols == 3) return countAllInputs<2, 3>(opt);
+    if (boxRows == 4 && boxCols == 4) return countAllInputs<4, 4>(opt);
+    if (boxRows == 5 && boxCols == 5) return countAllInputs<5, 5>(opt);
+    return countAllInputs<3, 3>(opt);
+}
+
+void printStats(const BatchSolver& solver)
+{
+    const auto counters = solver.counters();
+    for (size_t i = 0; i < counters.size(); ++i)
+        std::fprintf(stderr, "thread %zu: %llu puzzles, %.3f s busy, %.0f puzzles/s\n", i,
+            (unsigned long long)counters[i].puzzles, counters[i].busySeconds, counters[i].puzzlesPerSecond());
+    const auto stages = solver.stageCounters();
+    if (stages[0].boards == 0) return;
+    for (int i = 0; i < RatingPipeline::kStages; ++i)
+        std::fprintf(stderr, "stage %-12s %llu in, %llu settled, %.3f s, %.0f boards/s\n", RatingPipeline::stageName(i),
+            (unsigned long long)stages[i].boards, (unsigned long long)stages[i].settled, stages[i].seconds,
+            stages[i].boardsPerSecond());
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) { usage(); return 2; }
+
+    std::ios::sync_with_stdio(false);
+    std::cin.tie(nullptr);
+
+    if (opt.generate > 0) {
+        if (opt.shaped) {
+            GenerateOptions shape = opt.shape;
+            if (!shape.minimal && shape.clues == 0 && shape.minRating <= 0) shape.clues = difficultyOptions(opt.difficulty).clues;
+            const uint64_t seed = opt.seeded ? opt.seed : std::random_device{}();
+            size_t failed = 0;
+            PuzzleGenerator::generateStream(shape, opt.generate, opt.threads, seed, opt.first,
+                [&failed](uint64_t index, const SudokuBoard& b) {
+                    if (!isEmpty(b)) { std::cout << toPuzzleLine(b) << '\n'; return; }
+                    std::cerr << "puzzle " << index << ": no grid met the targets\n";
+                    ++failed;
+                });
+            if (failed) std::cerr << failed << " of " << opt.generate << " puzzles did not meet the targets\n";
+            return failed ? 1 : 0;
+        }
+        const auto print = [](uint64_t, const SudokuBoard& b) { std::cout << toPuzzleLine(b) << '\n'; };
+        if (opt.seeded) PuzzleGenerator::generateStream(opt.difficulty, opt.generate, opt.threads, opt.seed, opt.first, print);
+        else PuzzleGenerator::generateStream(opt.difficulty, opt.generate, opt.threads, print);
+        return 0;
+    }
+
+    if (!opt.pack.empty()) {
+        std::ifstream file;
+        if (!opt.files.empty() && opt.files[0] != "-") {
+            file.open(opt.files[0]);
+            if (!file) { std::cerr << "cannot open " << opt.files[0] << "\n"; return 1; }
+        }
+        std::string error;
+        if (packText(file.is_open() ? file : std::cin, opt.pack, error) < 0) { std::cerr << error << "\n"; return 1; }
+        return 0;
+    }
+    if (opt.unpack) {
+        int status = 0;
+        for (const auto& path : opt.files) {
+            MappedCorpus corpus;
+            if (!corpus.open(path)) { std::cerr << corpus.error() << "\n"; status = 1; continue; }
+            unpackText(corpus, std::cout);
+        }
+        return status;
+    }
+
+    if (opt.files.empty()) opt.files.push_back("-");
+    if (opt.countAll || opt.enumerate) {
+        const int status = countAllInputs(opt, opt.batch.boxRows, opt.batch.boxCols);
+        std::cout.flush();
+        return status;
+    }
+
+    std::unique_ptr<PuzzleCache> cache;
+    if (opt.cache > 0) {
+        cache = std::make_unique<PuzzleCache>(opt.cache);
+        opt.batch.cache = cache.get();
+    }
+    BatchSolver solver(opt.threads);
+    int status = 0;
+    for (const auto& path : opt.files) {
+        if (path == "-") { solver.run(std::cin, std::cout, opt.batch); continue; }
+        if (MappedCorpus::isCorpusFile(path)) {
+            MappedCorpus corpus;
+            if (opt.batch.boxRows != 3 || opt.batch.boxCols != 3) { std::cerr << "binary corpora are 9x9 only\n"; status = 1; continue; }
+            if (!corpus.open(path)) { std::cerr << corpus.error() << "\n"; status = 1; continue; }
+            solver.run(corpus, std::cout, opt.batch);
+            continue;
+        }
+        std::ifstream in(path);
+        if (!in) { std::cerr << "cannot open " << path << "\n"; status = 1; continue; }
+        solver.run(in, std::cout, opt.batch);
+    }
+    std::cout.flush();
+    if (opt.stats) printStats(solver);
+    if (opt.stats && cache)
+        std::fprintf(stderr, "cache: %zu hits, %zu misses, %zu evictions, %zu first seen\n", cache->hits(), cache->misses(),
+            cache->evictions(), cache->skipped());
+    return status;
+}
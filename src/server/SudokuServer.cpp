@@ -0,0 +1,545 @@
+// Local solving daemon: keeps warm Service instances behind a Unix domain socket (and
+// optionally a localhost TCP port) so clients do not link the engine or pay for its
+// setup on every call.
+//
+//   sudoku_server [--socket=PATH] [--port=N] [--threads=N] [--batch=N] [--cache=N] [--traces=N]
+//                 [--timeout=MS]
+//
+// Line protocol, one request per line, one reply line per request in request order:
+//
+//   solve PUZZLE            ok SOLUTION | none
+//   count PUZZLE [LIMIT]    ok N                      (solutions, capped at LIMIT, default 2)
+//   rate PUZZLE             ok RATING                 (Service::rateDifficulty)
+//   hint PUZZLE [BOARD]     ok ROW COL DIGIT STRATEGY | none   (row and column from 0)
+//   generate [1|2|3]        ok PUZZLE                 (difficulty, default 2)
+//   stats                   ok key=value...           (queue depth, batches, latency)
+//
+// PUZZLE is 81 characters as in PuzzleIO.h. A hint is for BOARD, the puzzle's givens
+// plus the placements made so far (default: the puzzle itself). It names the logical
+// strategy that finds it, or "Solution" when the pipeline is stuck and the digit comes
+// from solving the board. The solve trace behind the hints is recorded once per puzzle
+// and kept in an LRU of --traces (default 1024) puzzles under their canonical key, so
+// the later hints of a game are lookups. Failures reply "error MESSAGE"; a search that
+// outlives --timeout (default 1000 ms) replies "error timeout". Clients may pipeline
+// any number of requests.
+//
+// One thread owns every socket. Each pass of its poll loop reads all pending input,
+// queues the complete lines, and hands up to --batch queued requests at a time to a
+// work-stealing pool whose workers each keep their own Service. Requests that arrive
+// while a batch runs wait in the queue and go out together in the next one. A batch of
+// one request runs directly on the I/O thread to keep single-client round trips short.
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "PuzzleIO.h"
+#include "Service.h"
+#include "TraceCache.h"
+#include "WorkStealingPool.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kMaxLine = 1024;
+constexpr size_t kMaxPendingOutput = 1 << 20;  // stop reading a client that does not read its replies
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+struct Options {
+    std::string socketPath = "/tmp/sudoku.sock";
+    int port = 0;
+    unsigned threads = 0;
+    size_t maxBatch = 256;
+    size_t cache = 0;
+    size_t traces = 1024;
+    int timeoutMs = 1000;
+};
+
+struct Connection {
+    int fd = -1;
+    std::string in, out;
+    size_t inFlight = 0;  // queued or running requests
+    bool closing = false; // peer gone or protocol error: no more reads
+};
+
+struct Request {
+    Connection* conn;
+    std::string line;
+    std::string reply;
+    Clock::time_point received, done;
+};
+
+// Latencies in power-of-two microsecond buckets; percentiles report the bucket's
+// upper bound.
+struct LatencyHistogram {
+    std::array<uint64_t, 40> buckets{};
+    uint64_t count = 0;
+    uint64_t maxUs = 0;
+
+    void add(Clock::duration d)
+    {
+        const uint64_t us = uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(d).count());
+        size_t b = 0;
+        while (b + 1 < buckets.size() && (uint64_t(1) << b) <= us) ++b;
+        ++buckets[b];
+        ++count;
+        maxUs = std::max(maxUs, us);
+    }
+
+    uint64_t percentileUs(double p) const
+    {
+        if (count == 0) return 0;
+        const uint64_t rank = uint64_t(p * double(count - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < buckets.size(); ++b)
+            if ((seen += buckets[b]) >= rank) return std::min(uint64_t(1) << b, maxUs);
+        return maxUs;
+    }
+};
+
+std::string_view nextToken(std::string_view& s)
+{
+    size_t start = s.find_first_not_of(" \t\r");
+    if (start == std::string_view::npos) { s = {}; return {}; }
+    s.remove_prefix(start);
+    size_t end = s.find_first_of(" \t\r");
+    std::string_view token = s.substr(0, end);
+    s.remove_prefix(end == std::string_view::npos ? s.size() : end);
+    return token;
+}
+
+bool parsePuzzleToken(std::string_view token, SudokuBoard& board)
+{
+    return token.size() == 81 && parsePuzzleLine(token, board);
+}
+
+bool parseNumber(std::string_view token, long& value)
+{
+    if (token.empty() || token.size() > 10) return false;
+    value = 0;
+    for (char ch : token) {
+        if (ch < '0' || ch > '9') return false;
+        value = value * 10 + (ch - '0');
+    }
+    return true;
+}
+
+// Computes the reply to one solve/count/rate/hint/generate request.
+void handle(Service& service, const Options& opt, TraceCache& traces, Request& req)
+{
+    std::string_view rest = req.line;
+    const std::string_view command = nextToken(rest);
+    std::string& reply = req.reply;
+
+    if (command == "generate") {
+        long difficulty = 2;
+        const std::string_view arg = nextToken(rest);
+        if (!arg.empty() && (!parseNumber(arg, difficulty) || difficulty < 1 || difficulty > 3)) {
+            reply = "error difficulty must be 1, 2 or 3";
+            return;
+        }
+        reply = "ok " + toPuzzleLine(service.generateBoard(int(difficulty)));
+        return;
+    }
+    if (command != "solve" && command != "count" && command != "rate" && command != "hint") {
+        reply = "error unknown command";
+        return;
+    }
+    SudokuBoard board;
+    if (!parsePuzzleToken(nextToken(rest), board)) { reply = "error expected an 81-character puzzle"; return; }
+    SudokuBoard current = board;
+    if (command == "hint") {
+        const std::string_view arg = nextToken(rest);
+        bool extends = arg.empty() || parsePuzzleToken(arg, current);
+        for (int i = 0; i < 81 && extends; ++i)
+            extends = !board.at(i / 9, i % 9) || board.at(i / 9, i % 9) == current.at(i / 9, i % 9);
+        if (!extends) { reply = "error expected a board that keeps the puzzle's givens"; return; }
+    }
+    long limit = 2;
+    if (command == "count") {
+        const std::string_view arg = nextToken(rest);
+        if (!arg.empty() && (!parseNumber(arg, limit) || limit < 1 || limit > 1000000000)) {
+            reply = "error limit must be between 1 and 1000000000";
+            return;
+        }
+    }
+
+    CancelToken cancel;
+    cancel.setTimeout(std::chrono::milliseconds(opt.timeoutMs));
+    service.setCancel(&cancel);
+    service.loadBoard(board);
+    if (command == "solve") {
+        reply = service.solve() ? "ok " + toPuzzleLine(service.getBoard()) : "none";
+    }
+    else if (command == "count") {
+        reply = "ok " + std::to_string(service.countSolutions(int(limit)));
+    }
+    else if (command == "rate") {
+        char buf[16];
+        std::snprintf(buf, sizeof buf, "ok %.1f", service.rateDifficulty());
+        reply = buf;
+    }
+    else {
+        // Everything happens in the canonical frame the trace was recorded in.
+        const CanonicalForm form = canonicalize(board);
+        const std::shared_ptr<const CachedTrace> entry = traces.get(form);
+        const SudokuBoard frame = form.transform.apply(current);
+        bool onSolution = entry->solvable;
+        for (int i = 0; i < 81 && onSolution; ++i)
+            if (int v = frame.at(i / 9, i % 9)) onSolution = v == entry->solution.at(i / 9, i % 9);
+        // A board off the stored solution may still have one of its own.
+        SudokuBoard solved = entry->solution;
+        service.loadBoard(frame);
+        bool solvable = onSolution;
+        if (!solvable && service.solve()) {
+            solvable = true;
+            solved = service.getBoard();
+            service.loadBoard(frame);
+        }
+        Step step;
+        step.row = -1;
+        if (solvable) {
+            service.setTrace(&entry->trace);
+            if (!service.getHint(step)) {
+                for (int i = 0; i < 81 && step.row < 0; ++i)
+                    if (!frame.at(i / 9, i % 9)) step = { Strategy::None, i / 9, i % 9, solved.at(i / 9, i % 9) };
+            }
+            service.setTrace(nullptr);
+        }
+        if (step.row < 0) {
+            reply = "none";
+        }
+        else {
+            form.transform.invert(step.row, step.col, step.num);
+            reply = "ok " + std::to_string(step.row) + ' ' + std::to_string(step.col) + ' ' + std::to_string(step.num) +
+                ' ' + (step.strategy == Strategy::None ? "Solution" : strategyName(step.strategy));
+        }
+    }
+    service.setCancel(nullptr);
+    if (cancel.timedOut()) reply = "error timeout";
+}
+
+bool setNonBlocking(int fd)
+{
+    const int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+class Server {
+public:
+    explicit Server(const Options& opt) : opt_(opt), pool_(opt.threads)
+    {
+        if (opt_.cache > 0) cache_ = std::make_unique<PuzzleCache>(opt_.cache);
+        traces_ = std::make_unique<TraceCache>(opt_.traces);
+        for (unsigned i = 0; i <= pool_.size(); ++i) {
+            services_.push_back(std::make_unique<Worker>());
+            services_.back()->service.setEngine(Engine::Candidates);
+            services_.back()->service.setCache(cache_.get());
+        }
+    }
+
+    ~Server()
+    {
+        for (auto& c : connections_) close(c->fd);
+        for (int fd : listeners_) close(fd);
+        if (unixBound_) unlink(opt_.socketPath.c_str());
+    }
+
+    bool listen(std::string& error);
+    void run();
+
+private:
+    struct alignas(64) Worker {
+        Service service;
+    };
+
+    Options opt_;
+    WorkStealingPool pool_;
+    // One Service per pool worker, plus the last one for the I/O thread.
+    std::vector<std::unique_ptr<Worker>> services_;
+    std::unique_ptr<PuzzleCache> cache_;
+    std::unique_ptr<TraceCache> traces_;
+    std::vector<int> listeners_;
+    bool unixBound_ = false;
+    std::vector<std::unique_ptr<Connection>> connections_;
+    std::deque<Request> queue_;
+
+    uint64_t requests_ = 0;
+    uint64_t batches_ = 0;
+    size_t largestBatch_ = 0;
+    LatencyHistogram latency_;
+
+    void accept(int listener);
+    void read(Connection& c);
+    void write(Connection& c);
+    void runBatch();
+    std::string stats() const;
+};
+
+bool Server::listen(std::string& error)
+{
+    if (!opt_.socketPath.empty()) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (opt_.socketPath.size() >= sizeof addr.sun_path) { error = "socket path too long"; return false; }
+        std::memcpy(addr.sun_path, opt_.socketPath.c_str(), opt_.socketPath.size() + 1);
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) { error = std::string("socket: ") + std::strerror(errno); return false; }
+        // A path nobody answers on is left over from a crashed server.
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) == 0) {
+            close(fd);
+            error = opt_.socketPath + " is already served";
+            return false;
+        }
+        unlink(opt_.socketPath.c_str());
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) < 0 || ::listen(fd, SOMAXCONN) < 0 ||
+            !setNonBlocking(fd)) {
+            error = opt_.socketPath + ": " + std::strerror(errno);
+            close(fd);
+            return false;
+        }
+        unixBound_ = true;
+        listeners_.push_back(fd);
+    }
+    if (opt_.port > 0) {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(uint16_t(opt_.port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        const int fd = socket(AF_INET, SOCK_STREAM, 0);
+        const int one = 1;
+        if (fd < 0) { error = std::string("socket: ") + std::strerror(errno); return false; }
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) < 0 || ::listen(fd, SOMAXCONN) < 0 ||
+            !setNonBlocking(fd)) {
+            error = "port " + std::to_string(opt_.port) + ": " + std::strerror(errno);
+            close(fd);
+            return false;
+        }
+        listeners_.push_back(fd);
+    }
+    if (listeners_.empty()) { error = "nothing to listen on"; return false; }
+    return true;
+}
+
+void Server::accept(int listener)
+{
+    for (;;) {
+        const int fd = ::accept(listener, nullptr, nullptr);
+        if (fd < 0) return;
+        if (!setNonBlocking(fd)) { close(fd); continue; }
+        const int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);  // fails harmlessly on Unix sockets
+        connections_.push_back(std::make_unique<Connection>());
+        connections_.back()->fd = fd;
+    }
+}
+
+void Server::read(Connection& c)
+{
+    char buf[65536];
+    for (;;) {
+        const ssize_t n = ::read(c.fd, buf, sizeof buf);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) { c.closing = true; break; }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        c.in.append(buf, size_t(n));
+        if (size_t(n) < sizeof buf) break;
+    }
+
+    const Clock::time_point now = Clock::now();
+    size_t start = 0;
+    for (size_t nl; (nl = c.in.find('\n', start)) != std::string::npos; start = nl + 1) {
+        std::string line = c.in.substr(start, nl - start);
+        if (line.empty() || line == "\r") continue;
+        ++c.inFlight;
+        queue_.push_back({ &c, std::move(line), {}, now, {} });
+    }
+    c.in.erase(0, start);
+    if (c.in.size() > kMaxLine) {
+        c.out += "error line too long\n";
+        c.in.clear();
+        c.closing = true;
+    }
+}
+
+void Server::write(Connection& c)
+{
+    while (!c.out.empty()) {
+        const ssize_t n = ::write(c.fd, c.out.data(), c.out.size());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) { c.out.clear(); c.closing = true; }
+            return;
+        }
+        c.out.erase(0, size_t(n));
+    }
+}
+
+std::string Server::stats() const
+{
+    const PuzzleCache* cache = cache_.get();
+    return "ok requests=" + std::to_string(requests_) + " batches=" + std::to_string(batches_) +
+        " queued=" + std::to_string(queue_.size()) + " largest_batch=" + std::to_string(largestBatch_) +
+        " connections=" + std::to_string(connections_.size()) + " threads=" + std::to_string(pool_.size()) +
+        " p50_us=" + std::to_string(latency_.percentileUs(0.5)) + " p99_us=" + std::to_string(latency_.percentileUs(0.99)) +
+        " max_us=" + std::to_string(latency_.maxUs) + " cache_hits=" + std::to_string(cache ? cache->hits() : 0) +
+        " cache_misses=" + std::to_string(cache ? cache->misses() : 0) +
+        " cache_first_seen=" + std::to_string(cache ? cache->skipped() : 0) +
+        " trace_hits=" + std::to_string(traces_->hits()) + " trace_misses=" + std::to_string(traces_->misses());
+}
+
+void Server::runBatch()
+{
+    const size_t n = std::min(queue_.size(), opt_.maxBatch);
+    // Stats are answered here, in order with the rest of the batch, and not timed.
+    for (size_t i = 0; i < n; ++i) {
+        std::string_view rest = queue_[i].line;
+        if (nextToken(rest) == "stats" && nextToken(rest).empty()) queue_[i].reply = stats();
+    }
+
+    auto work = [this](Service& service, size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            Request& req = queue_[i];
+            if (!req.reply.empty()) continue;
+            handle(service, opt_, *traces_, req);
+            req.done = Clock::now();
+        }
+    };
+    if (n == 1) {
+        work(services_.back()->service, 0, 1);
+    }
+    else {
+        // A few chunks per worker so stealing can even out slow requests.
+        const size_t chunk = std::max<size_t>(1, n / (4 * pool_.size()));
+        for (size_t first = 0; first < n; first += chunk) {
+            const size_t last = std::min(n, first + chunk);
+            pool_.submit([this, &work, first, last](unsigned wi) { work(services_[wi]->service, first, last); });
+        }
+        pool_.wait();
+    }
+
+    ++batches_;
+    largestBatch_ = std::max(largestBatch_, n);
+    for (size_t i = 0; i < n; ++i) {
+        Request& req = queue_.front();
+        if (req.done != Clock::time_point{}) {
+            ++requests_;
+            latency_.add(req.done - req.received);
+        }
+        Connection& c = *req.conn;
+        --c.inFlight;
+        c.out += req.reply;
+        c.out += '\n';
+        queue_.pop_front();
+    }
+}
+
+void Server::run()
+{
+    std::vector<pollfd> fds;
+    while (!stopRequested) {
+        fds.clear();
+        for (int fd : listeners_) fds.push_back({ fd, POLLIN, 0 });
+        for (auto& c : connections_) {
+            short events = 0;
+            if (!c->closing && c->out.size() < kMaxPendingOutput) events |= POLLIN;
+            if (!c->out.empty()) events |= POLLOUT;
+            fds.push_back({ c->fd, events, 0 });
+        }
+        // Queued requests left over from a full batch go out without waiting.
+        if (poll(fds.data(), nfds_t(fds.size()), queue_.empty() ? -1 : 0) < 0) {
+            if (errno == EINTR) continue;
+            std::perror("poll");
+            return;
+        }
+
+        for (size_t i = 0; i < listeners_.size(); ++i)
+            if (fds[i].revents & POLLIN) accept(listeners_[i]);
+        // Connections accepted above have no pollfd entry yet.
+        for (size_t i = listeners_.size(); i < fds.size(); ++i) {
+            Connection& c = *connections_[i - listeners_.size()];
+            if (!c.closing && (fds[i].revents & (POLLIN | POLLHUP | POLLERR))) read(c);
+        }
+
+        if (!queue_.empty()) runBatch();
+
+        for (auto& c : connections_) write(*c);
+        connections_.erase(std::remove_if(connections_.begin(), connections_.end(), [](const std::unique_ptr<Connection>& c) {
+            if (!c->closing || c->inFlight > 0 || !c->out.empty()) return false;
+            close(c->fd);
+            return true;
+        }), connections_.end());
+    }
+}
+
+void onSignal(int) { stopRequested = 1; }
+
+void usage()
+{
+    std::cerr << "usage: sudoku_server [--socket=PATH] [--port=N] [--threads=N] [--batch=N] [--cache=N] [--traces=N]\n"
+                 "                     [--timeout=MS]\n";
+}
+
+bool parseArgs(int argc, char* argv[], Options& opt)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a.rfind("--socket=", 0) == 0) opt.socketPath = a.substr(9);
+        else if (a.rfind("--port=", 0) == 0) opt.port = std::atoi(a.c_str() + 7);
+        else if (a.rfind("--threads=", 0) == 0) opt.threads = unsigned(std::atoi(a.c_str() + 10));
+        else if (a.rfind("--batch=", 0) == 0) opt.maxBatch = size_t(std::strtoull(a.c_str() + 8, nullptr, 10));
+        else if (a.rfind("--cache=", 0) == 0) opt.cache = size_t(std::strtoull(a.c_str() + 8, nullptr, 10));
+        else if (a.rfind("--traces=", 0) == 0) opt.traces = size_t(std::strtoull(a.c_str() + 9, nullptr, 10));
+        else if (a.rfind("--timeout=", 0) == 0) opt.timeoutMs = std::atoi(a.c_str() + 10);
+        else if (a == "-h" || a == "--help") return false;
+        else { std::cerr << "unknown option " << a << "\n"; return false; }
+    }
+    if (opt.maxBatch < 1) { std::cerr << "--batch must be positive\n"; return false; }
+    if (opt.timeoutMs < 1) { std::cerr << "--timeout must be positive\n"; return false; }
+    if (opt.port < 0 || opt.port > 65535) { std::cerr << "--port out of range\n"; return false; }
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) { usage(); return 2; }
+
+    struct sigaction sa{};
+    sa.sa_handler = onSignal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    Server server(opt);
+    std::string error;
+    if (!server.listen(error)) { std::cerr << error << "\n"; return 1; }
+    server.run();
+    return 0;
+}